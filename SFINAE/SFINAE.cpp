@@ -2,6 +2,8 @@
 #include <type_traits>
 #include <vector>
 
+#include "../template/num_format.h"
+
 template <typename T>
 typename std::enable_if<std::is_integral<T>::value, void>::type
 print (T t) {
@@ -55,14 +57,14 @@ template <typename T>
 concept Intergal = std::is_integral_v<T>;
 template <Intergal T>
 void conceptPrint(T t) {
-    std::cout << "T is intergal! " << t << std::endl;
+    numfmt::put(std::cout << "T is intergal! ", t) << std::endl;
 }
 
 template <typename T>
 concept FloatingPoint = std::is_floating_point_v<T>;
 template <FloatingPoint T>
 void conceptPrint(T t) {
-    std::cout << "T is floating point! " << t << std::endl;
+    numfmt::put(std::cout << "T is floating point! ", t) << std::endl;
 }
 
 template <typename T>
@@ -84,7 +86,7 @@ requires(!Intergal<T> && !FloatingPoint<T> && !Cstring<T> && !String<T>)
 void conceptPrint(T t) {
     std::cout << "T is unknown type! " << std::endl;
     for (auto &item : t) {
-        std::cout << item << " ";
+        numfmt::put(std::cout, item) << " ";
     }
 }
 
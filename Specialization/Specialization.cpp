@@ -1,9 +1,12 @@
 #include <iostream>
 
+#include "../template/num_format.h"
+
 // 全特化
 template <typename T>
 void print(T t) {
-    std::cout << "t = " << t << std::endl;
+    // 数值与指针直接写进栈上缓冲区，浮点数取能精确还原的最短表示
+    numfmt::put(std::cout << "t = ", t) << std::endl;
 }
 
 template <>
@@ -1,4 +1,9 @@
 #include <iostream>
+#include <string>
+#include <vector>
+
+#include "print_writer.h"
+#include "reduce.h"
 
 // 右折叠 (Right Fold) ->  (... - args)
 template <typename... Args>
@@ -41,12 +46,11 @@ auto logicalOr(Args... args) -> decltype(auto)
     return (args || ...);  // a || b || c || d
 }
 
-// 逗号折叠 (用于打印)
+// 逗号折叠 (用于打印)：先折叠出输出长度的上界，再把各参数写进本线程的缓冲区，整行一次 write
 template <typename... Args>
-void printAll(Args... args)
+void printAll(const Args&... args)
 {
-    ((std::cout << args << " "), ...);  // 逗号折叠
-    std::cout << std::endl;
+    printing::print_writer::local().line(args...);
 }
 
 int main()
@@ -69,6 +73,47 @@ int main()
     // 逗号折叠
     std::cout << "打印所有参数: ";
     printAll(1, "hello", 3.14, true);
+
+    // 批量输出：作用域内的各行攒在缓冲区里，离开作用域时一次写出
+    {
+        printing::print_batch batch;
+        for (int row = 0; row < 3; ++row) {
+            printAll("row", row, row * 0.5, std::string("ok"));
+        }
+    }
+
+    // 通用归约：运算的单位元、结合律、交换律由 op_traits 声明
+    std::cout << "=== reduce<Op> 示例 ===" << std::endl;
+    std::cout << "reduce<minus> 左折叠 (1, 10, 3.14, 666): " << reduce<std::minus<>>(1, 10, 3.14, 666) << std::endl;
+    std::cout << "reduce_right<minus> 右折叠 (1, 10, 3.14, 666): " << reduce_right<std::minus<>>(1, 10, 3.14, 666)
+              << std::endl;
+    std::cout << "reduce<logical_and> (true, false, true): " << reduce<std::logical_and<>>(true, false, true)
+              << std::endl;
+    std::cout << "reduce<logical_or> (true, false, false): " << reduce<std::logical_or<>>(true, false, false)
+              << std::endl;
+    std::cout << "reduce<max> (3, 9, 2, 7): " << reduce<ops::max>(3, 9, 2, 7) << std::endl;
+    std::cout << "reduce<plus> (string): " << reduce<std::plus<>>(std::string("Liu"), std::string("Shi"), std::string("jie"))
+              << std::endl;
+    static_assert(reduce<std::plus<>>(1, 2, 3, 4, 5) == 15, "constexpr reduce");
+    static_assert(reduce<std::minus<>>(10, 2, 2) == 6 && reduce_right<std::minus<>>(10, 2, 2) == 10,
+                  "minus keeps its fold direction");
+    static_assert(reduce_plan<std::plus<>, int>::vectorize && !reduce_plan<std::minus<>, int>::reassociate,
+                  "plans follow op_traits");
+
+    // 区间：可交换的算术运算按 lane 交错累加，只满足结合律的按连续段合并，减法严格左折叠
+    std::vector<int> values(100000);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<int>(i % 100);
+    }
+    std::vector<std::string> words{"a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l", "m", "n", "o", "p", "q"};
+    std::cout << "reduce<plus> (vector<int>): " << reduce<std::plus<>>(values) << std::endl;
+    std::cout << "reduce<max> (vector<int>): " << reduce<ops::max>(values) << std::endl;
+    std::cout << "reduce<bit_xor> (vector<int>): " << reduce<std::bit_xor<>>(values) << std::endl;
+    std::cout << "reduce<minus> (vector<int>): " << reduce<std::minus<>>(values) << std::endl;
+    std::cout << "reduce<plus> (vector<string>): " << reduce<std::plus<>>(words) << std::endl;
+    std::cout << "reduce<multiplies> (空区间): " << reduce<std::multiplies<>>(std::vector<double>{}) << std::endl;
+    std::cout << "parallel_reduce<plus> (vector<int>, 4 线程): " << parallel_reduce<std::plus<>>(values, 4)
+              << std::endl;
     
     return 0;
 } 
\ No newline at end of file
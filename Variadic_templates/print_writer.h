@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "../template/num_format.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// printAll 背后的缓冲写出器：每个线程一块缓冲区，一次调用先用折叠表达式算出输出长度的上界，
+// 预留一次空间后把各参数直接转换进去，最后整块交给一次 write(2)。
+//   逐次模式（默认）: 每次调用结束写出一次，与原来每行 std::endl 刷新的效果相同
+//   批量模式        : print_batch 存活期间只在缓冲区写满和离开作用域时写出，适合成批输出大量行
+// 写出之前会先刷新 std::cout，保证与之前经 std::cout 输出的内容顺序一致；
+// 批量模式期间不要再直接用 std::cout，否则它会排到这一批前面
+namespace printing {
+
+namespace detail {
+
+// 字符串统一成 string_view，只算一次长度；不认识的类型先经 operator<< 转成文本
+template <typename T>
+auto as_piece(const T& value) {
+    if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>) {
+        return std::string_view(value);
+    } else if constexpr (std::is_array_v<T> && std::is_same_v<std::remove_extent_t<T>, char>) {
+        const char* end = std::char_traits<char>::find(value, std::extent_v<T>, '\0');
+        return std::string_view(value, end ? static_cast<std::size_t>(end - value) : std::extent_v<T>);
+    } else if constexpr (std::is_pointer_v<T> && numfmt::is_narrow_character_v<std::remove_cv_t<std::remove_pointer_t<T>>>) {
+        // 与 std::cout 不同，空指针输出 "(null)" 而不是让流进入失败状态
+        return value ? std::string_view(reinterpret_cast<const char*>(value)) : std::string_view("(null)");
+    } else if constexpr (std::is_arithmetic_v<T> || std::is_pointer_v<T>) {
+        return value;
+    } else {
+        std::ostringstream os;
+        os << value;
+        return std::move(os).str();
+    }
+}
+
+// 转换后最多占用的字节数：数值和指针由类型决定，字符串用实际长度
+template <typename P>
+std::size_t bound(const P& piece) {
+    if constexpr (std::is_same_v<P, bool> || numfmt::is_narrow_character_v<P>) {
+        return 1;
+    } else if constexpr (numfmt::is_number_v<P>) {
+        return numfmt::max_chars<P>;
+    } else if constexpr (std::is_pointer_v<P>) {
+        return numfmt::max_pointer_chars;
+    } else {
+        return piece.size();
+    }
+}
+
+// 输出与 std::cout << piece 相同（bool 为 1 / 0，空 void* 为 0）
+template <typename P>
+char* put(char* out, const P& piece) {
+    if constexpr (std::is_same_v<P, bool>) {
+        *out++ = piece ? '1' : '0';
+        return out;
+    } else if constexpr (numfmt::is_narrow_character_v<P>) {
+        *out++ = static_cast<char>(piece);
+        return out;
+    } else if constexpr (numfmt::is_number_v<P>) {
+        return numfmt::write(out, piece);
+    } else if constexpr (std::is_pointer_v<P>) {
+        if (!piece) {
+            *out++ = '0';
+            return out;
+        }
+        return numfmt::write_pointer(out, piece);
+    } else {
+        std::memcpy(out, piece.data(), piece.size());
+        return out + piece.size();
+    }
+}
+
+inline void write_all(int fd, const char* data, std::size_t n) {
+    while (n > 0) {
+#ifdef _WIN32
+        const int k = ::_write(fd, data, static_cast<unsigned>(n));
+#else
+        const auto k = ::write(fd, data, n);
+#endif
+        if (k <= 0) {
+            return;
+        }
+        data += k;
+        n -= static_cast<std::size_t>(k);
+    }
+}
+
+} // namespace detail
+
+class print_writer {
+public:
+    static constexpr std::size_t default_capacity = std::size_t(1) << 16;
+
+    // 当前线程的写出器，输出到标准输出
+    static print_writer& local() {
+        thread_local print_writer writer(1);
+        return writer;
+    }
+
+    explicit print_writer(int fd, std::size_t capacity = default_capacity)
+        : fd_(fd), capacity_(capacity), data_(new char[capacity]) {}
+
+    print_writer(const print_writer&) = delete;
+    print_writer& operator=(const print_writer&) = delete;
+
+    ~print_writer() { flush(); }
+
+    // 保证末尾至少还有 n 字节可写：放不下时先写出已有内容，单条比整个缓冲区还大时扩容
+    char* reserve(std::size_t n) {
+        if (size_ + n > capacity_) {
+            flush();
+            if (n > capacity_) {
+                capacity_ = n;
+                data_.reset(new char[n]);
+            }
+        }
+        return data_.get() + size_;
+    }
+
+    void commit(const char* end) {
+        size_ = static_cast<std::size_t>(end - data_.get());
+        if (batch_depth_ == 0) {
+            flush();
+        }
+    }
+
+    void flush() {
+        if (size_ == 0) {
+            return;
+        }
+        std::cout.flush();
+        detail::write_all(fd_, data_.get(), size_);
+        size_ = 0;
+    }
+
+    // 一行：各参数之间和末尾各一个空格，然后换行
+    template <typename... Args>
+    void line(const Args&... args) {
+        row(std::forward_as_tuple(detail::as_piece(args)...), std::index_sequence_for<Args...>{});
+    }
+
+private:
+    friend class print_batch;
+
+    template <typename Pieces, std::size_t... I>
+    void row(const Pieces& pieces, std::index_sequence<I...>) {
+        const std::size_t n = ((detail::bound(std::get<I>(pieces)) + 1) + ... + 1);
+        char* p = reserve(n);
+        ((p = detail::put(p, std::get<I>(pieces)), *p++ = ' '), ...);
+        *p++ = '\n';
+        commit(p);
+    }
+
+    int fd_;
+    std::size_t capacity_;
+    std::unique_ptr<char[]> data_;
+    std::size_t size_ = 0;
+    int batch_depth_ = 0;
+};
+
+// 作用域内当前线程的 printAll 只在缓冲区写满时写出，离开作用域时写出剩余部分；可以嵌套
+class print_batch {
+public:
+    print_batch() : writer_(print_writer::local()) { ++writer_.batch_depth_; }
+
+    print_batch(const print_batch&) = delete;
+    print_batch& operator=(const print_batch&) = delete;
+
+    ~print_batch() {
+        if (--writer_.batch_depth_ == 0) {
+            writer_.flush();
+        }
+    }
+
+private:
+    print_writer& writer_;
+};
+
+} // namespace printing
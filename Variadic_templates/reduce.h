@@ -0,0 +1,357 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// 通用归约：reduce<Op>(args...) / reduce<Op>(range) / parallel_reduce<Op>(range, threads)
+// 每个运算通过 op_traits 声明单位元、结合律和交换律，库据此自动选择求值方式：
+//   不满足结合律（如 -、/）   : 严格按左折叠（reduce）或右折叠（reduce_right）求值
+//   满足结合律               : 参数包按平衡树求值；区间拆成若干连续段并行推进，可以多线程
+//   同时满足交换律的算术类型 : 区间按 lane 交错累加，编译器可以直接向量化
+// 浮点的 + 和 * 按数学性质视为满足结合律，重排后最后几位的舍入可能与严格左折叠不同
+
+// 1. 运算的性质；未特化的运算按"不满足结合律、没有单位元"处理
+template <typename Op, typename = void>
+struct op_traits {
+    static constexpr bool associative = false;
+    static constexpr bool commutative = false;
+};
+
+// 加法类运算的单位元用值初始化 T{}：算术类型得到 0，std::string 之类得到空值
+template <>
+struct op_traits<std::plus<>> {
+    template <typename T>
+    static constexpr T identity() { return T{}; }
+    static constexpr bool associative = true;
+    static constexpr bool commutative = true;
+};
+
+template <>
+struct op_traits<std::multiplies<>> {
+    template <typename T>
+    static constexpr T identity() { return T(1); }
+    static constexpr bool associative = true;
+    static constexpr bool commutative = true;
+};
+
+// 0 只是右单位元（a - 0 = a），空区间时返回它
+template <>
+struct op_traits<std::minus<>> {
+    template <typename T>
+    static constexpr T identity() { return T{}; }
+    static constexpr bool associative = false;
+    static constexpr bool commutative = false;
+};
+
+template <>
+struct op_traits<std::divides<>> {
+    template <typename T>
+    static constexpr T identity() { return T(1); }
+    static constexpr bool associative = false;
+    static constexpr bool commutative = false;
+};
+
+template <>
+struct op_traits<std::logical_and<>> {
+    template <typename T>
+    static constexpr T identity() { return T(true); }
+    static constexpr bool associative = true;
+    static constexpr bool commutative = true;
+};
+
+template <>
+struct op_traits<std::logical_or<>> {
+    template <typename T>
+    static constexpr T identity() { return T(false); }
+    static constexpr bool associative = true;
+    static constexpr bool commutative = true;
+};
+
+template <>
+struct op_traits<std::bit_and<>> {
+    template <typename T>
+    static constexpr T identity() { return static_cast<T>(~T(0)); }
+    static constexpr bool associative = true;
+    static constexpr bool commutative = true;
+};
+
+template <>
+struct op_traits<std::bit_or<>> {
+    template <typename T>
+    static constexpr T identity() { return T{}; }
+    static constexpr bool associative = true;
+    static constexpr bool commutative = true;
+};
+
+template <>
+struct op_traits<std::bit_xor<>> {
+    template <typename T>
+    static constexpr T identity() { return T{}; }
+    static constexpr bool associative = true;
+    static constexpr bool commutative = true;
+};
+
+// 标准库没有的两个常用运算
+namespace ops {
+
+struct min {
+    template <typename T>
+    constexpr T operator()(const T& a, const T& b) const { return b < a ? b : a; }
+};
+
+struct max {
+    template <typename T>
+    constexpr T operator()(const T& a, const T& b) const { return a < b ? b : a; }
+};
+
+} // namespace ops
+
+template <>
+struct op_traits<ops::min> {
+    template <typename T>
+    static constexpr T identity() { return std::numeric_limits<T>::max(); }
+    static constexpr bool associative = true;
+    static constexpr bool commutative = true;
+};
+
+template <>
+struct op_traits<ops::max> {
+    template <typename T>
+    static constexpr T identity() { return std::numeric_limits<T>::lowest(); }
+    static constexpr bool associative = true;
+    static constexpr bool commutative = true;
+};
+
+// 2. 检测运算对类型 T 是否声明了单位元
+template <typename Op, typename T, typename = void>
+struct has_identity : std::false_type {};
+
+template <typename Op, typename T>
+struct has_identity<Op, T, std::void_t<decltype(op_traits<Op>::template identity<T>())>> : std::true_type {};
+
+// 3. 由性质推出的求值方式，可以用 static_assert 检查某个指标会怎样被归约
+template <typename Op, typename T>
+struct reduce_plan {
+    static constexpr bool reassociate = op_traits<Op>::associative;
+    static constexpr bool vectorize = reassociate && op_traits<Op>::commutative && std::is_arithmetic_v<T>;
+    static constexpr bool parallelize = reassociate;
+};
+
+// 区间内核同时推进的累加器个数
+inline constexpr std::size_t reduce_lanes = 8;
+
+namespace detail {
+
+// 把每个参数包进 operand，让折叠表达式可以使用任意二元运算
+template <typename Op, typename T>
+struct operand {
+    T value;
+};
+
+template <typename Op, typename T>
+constexpr operand<Op, T> wrap(T value) {
+    return {std::move(value)};
+}
+
+template <typename Op, typename A, typename B>
+constexpr auto operator|(operand<Op, A> a, operand<Op, B> b) {
+    return wrap<Op>(Op{}(std::move(a.value), std::move(b.value)));
+}
+
+// 满足结合律时按下标两两分治，依赖链只有 O(log N) 层
+template <typename Op, typename T>
+constexpr T reduce_tree(const T* p, std::size_t n) {
+    if (n == 1) {
+        return p[0];
+    }
+    const std::size_t half = n / 2;
+    return Op{}(reduce_tree<Op>(p, half), reduce_tree<Op>(p + half, n - half));
+}
+
+template <typename R, typename = void>
+struct is_contiguous_range : std::false_type {};
+
+template <typename R>
+struct is_contiguous_range<R, std::void_t<decltype(std::data(std::declval<R&>())),
+                                          decltype(std::size(std::declval<R&>()))>>
+    : std::is_pointer<decltype(std::data(std::declval<R&>()))> {};
+
+template <typename R>
+using range_value_t = std::remove_cv_t<std::remove_pointer_t<decltype(std::data(std::declval<R&>()))>>;
+
+template <typename Op, typename T>
+using reduce_result_t = std::decay_t<std::invoke_result_t<Op, T, T>>;
+
+template <typename Op, typename T>
+auto empty_result() {
+    using U = reduce_result_t<Op, T>;
+    if constexpr (has_identity<Op, U>::value) {
+        return op_traits<Op>::template identity<U>();
+    } else {
+        return U{};
+    }
+}
+
+// 严格左折叠
+template <typename Op, typename T>
+auto reduce_left(const T* p, std::size_t n) {
+    reduce_result_t<Op, T> acc = p[0];
+    for (std::size_t i = 1; i < n; ++i) {
+        acc = Op{}(acc, p[i]);
+    }
+    return acc;
+}
+
+// 可交换：第 i 个元素进入第 i % L 个累加器，彼此独立的 L 条依赖链可以直接映射到向量寄存器
+template <typename Op, typename T>
+auto reduce_interleaved(const T* p, std::size_t n) {
+    constexpr std::size_t L = reduce_lanes;
+    if (n < 2 * L) {
+        return reduce_left<Op>(p, n);
+    }
+    reduce_result_t<Op, T> acc[L];
+    for (std::size_t j = 0; j < L; ++j) {
+        acc[j] = p[j];
+    }
+    std::size_t i = L;
+    for (; i + L <= n; i += L) {
+        for (std::size_t j = 0; j < L; ++j) {
+            acc[j] = Op{}(acc[j], p[i + j]);
+        }
+    }
+    for (; i < n; ++i) {
+        acc[i % L] = Op{}(acc[i % L], p[i]);
+    }
+    return reduce_tree<Op>(acc, L);
+}
+
+// 只满足结合律：切成 L 个连续段同步推进，最后按段的顺序合并，元素相对次序不变
+template <typename Op, typename T>
+auto reduce_segments(const T* p, std::size_t n) {
+    constexpr std::size_t L = reduce_lanes;
+    if (n < 2 * L) {
+        return reduce_left<Op>(p, n);
+    }
+    const std::size_t len = n / L;
+    reduce_result_t<Op, T> acc[L];
+    for (std::size_t j = 0; j < L; ++j) {
+        acc[j] = p[j * len];
+    }
+    for (std::size_t i = 1; i < len; ++i) {
+        for (std::size_t j = 0; j < L; ++j) {
+            acc[j] = Op{}(acc[j], p[j * len + i]);
+        }
+    }
+    for (std::size_t i = L * len; i < n; ++i) {
+        acc[L - 1] = Op{}(acc[L - 1], p[i]);
+    }
+    return reduce_tree<Op>(acc, L);
+}
+
+// 非空连续区间按性质选择内核
+template <typename Op, typename T>
+auto reduce_contiguous(const T* p, std::size_t n) {
+    if constexpr (reduce_plan<Op, T>::vectorize) {
+        return reduce_interleaved<Op>(p, n);
+    } else if constexpr (reduce_plan<Op, T>::reassociate) {
+        return reduce_segments<Op>(p, n);
+    } else {
+        return reduce_left<Op>(p, n);
+    }
+}
+
+} // namespace detail
+
+// 4. 参数包：左折叠 ((a op b) op c) op d；满足结合律且类型一致时改为平衡树
+template <typename Op, typename... Args>
+constexpr auto reduce(Args... args) {
+    static_assert(sizeof...(args) > 0, "At least one argument is required");
+    using CommonType = std::common_type_t<Args...>;
+
+    if constexpr (reduce_plan<Op, CommonType>::reassociate && sizeof...(args) > 2 &&
+                  std::is_same_v<detail::reduce_result_t<Op, CommonType>, CommonType>) {
+        const CommonType values[] = {static_cast<CommonType>(args)...};
+        return detail::reduce_tree<Op>(values, sizeof...(args));
+    } else {
+        return (... | detail::wrap<Op>(args)).value;
+    }
+}
+
+// 右折叠 a op (b op (c op d))；满足结合律时与 reduce 相同
+template <typename Op, typename... Args>
+constexpr auto reduce_right(Args... args) {
+    static_assert(sizeof...(args) > 0, "At least one argument is required");
+    using CommonType = std::common_type_t<Args...>;
+
+    if constexpr (reduce_plan<Op, CommonType>::reassociate) {
+        return reduce<Op>(args...);
+    } else {
+        return (detail::wrap<Op>(args) | ...).value;
+    }
+}
+
+// 单个连续区间参数总是按元素归约（只有一个值的参数包本来就等于它自己），
+// 所以 reduce<ops::max>(vec) 求的是元素最大值，而不是把 vec 当作一个可比较的值
+template <typename Op, typename R, typename = void>
+struct is_reduce_range : std::false_type {};
+
+template <typename Op, typename R>
+struct is_reduce_range<Op, R, std::enable_if_t<detail::is_contiguous_range<R>::value>>
+    : std::is_invocable<Op, const detail::range_value_t<R>&, const detail::range_value_t<R>&> {};
+
+template <typename Op, typename R>
+inline constexpr bool is_reduce_range_v = is_reduce_range<Op, R>::value;
+
+// 5. 连续区间：std::vector / std::array / 原生数组等；空区间返回单位元
+template <typename Op, typename R, std::enable_if_t<is_reduce_range_v<Op, R>, int> = 0>
+auto reduce(const R& range) {
+    using T = detail::range_value_t<R>;
+    const T* p = std::data(range);
+    const std::size_t n = std::size(range);
+    if (n == 0) {
+        return detail::empty_result<Op, T>();
+    }
+    return detail::reduce_contiguous<Op>(p, n);
+}
+
+// 多线程版本：只有满足结合律的运算才会拆分，各段结果按段的顺序合并，不要求交换律；
+// 否则退回单线程的严格左折叠
+template <typename Op, typename R, std::enable_if_t<is_reduce_range_v<Op, R>, int> = 0>
+auto parallel_reduce(const R& range, std::size_t threads = std::thread::hardware_concurrency()) {
+    using T = detail::range_value_t<R>;
+    const T* p = std::data(range);
+    const std::size_t n = std::size(range);
+    // 每个线程至少分到这么多元素才值得启动
+    constexpr std::size_t min_chunk = std::size_t(1) << 14;
+    if (threads > n / min_chunk) {
+        threads = n / min_chunk;
+    }
+    if constexpr (!reduce_plan<Op, T>::parallelize) {
+        return reduce<Op>(range);
+    } else {
+        if (threads <= 1) {
+            return reduce<Op>(range);
+        }
+        using U = detail::reduce_result_t<Op, T>;
+        std::vector<U> partials(threads);
+        std::vector<std::thread> workers;
+        const std::size_t chunk = n / threads;
+        for (std::size_t t = 1; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                const std::size_t len = t + 1 == threads ? n - t * chunk : chunk;
+                partials[t] = detail::reduce_contiguous<Op>(p + t * chunk, len);
+            });
+        }
+        partials[0] = detail::reduce_contiguous<Op>(p, chunk);
+        for (std::thread& w : workers) {
+            w.join();
+        }
+        return detail::reduce_tree<Op>(partials.data(), threads);
+    }
+}
@@ -1,47 +1,13 @@
+#include <filesystem>
 #include <iostream>
+#include <string>
+#include <thread>
 #include <type_traits>
 
-template <typename T, typename U = void>
-class Logger {
-public:
-    static void log(const T& message) {
-        std::cout << "Log: " << message << std::endl;
-    }
-};
-
-
-template <typename T>
-class Logger<T, std::enable_if_t<std::is_pointer_v<T>>> {
-public:
-    static void log(const T& message) {
-        if (message) {
-            std::cout << "Log*: " << message << std::endl;
-        } else {
-            std::cout << "Log: nullptr" << std::endl;
-        }
-    }
-};
-
-template<>
-class Logger<std::string> {
-public:
-    static void log(const std::string message) {
-        std::cout << "StringLog: " << message << std::endl;
-    } 
-};
-
-template <typename T>
-class LogOne {
-public:
-    static void logOne(const T& message) {
-        Logger<T>::log(message);
-    }
-};
-
-template <typename... Args>
-void logAll(const Args&... args) {
-    (LogOne<Args>::logOne(args), ...);
-}
+#include "format.h"
+#include "log_crash.h"
+#include "log_kv.h"
+#include "logger.h"
 
 template <int N>
 struct Fibonacci {
@@ -85,6 +51,15 @@ struct Sum<N, Rest...> {
 };
 
 int main() {
+    using namespace logging::literals;
+
+    // 崩溃时把各级缓冲区里还没写出的日志用 write(2) 写出去，再附上调用栈
+    logging::install_crash_handler();
+
+    // 演示写出的日志文件都放在临时目录里，结束时删除
+    const std::filesystem::path scratch = std::filesystem::temp_directory_path() / "metaprogram-demo";
+    std::filesystem::create_directories(scratch);
+
     // Example usage of Logger with different types
     // Logger<int>::log(42);
     // Logger<const char *>::log("Hello World!");
@@ -94,6 +69,125 @@ int main() {
     // std::string s = "Hello String!";
     // logAll(x, str, s);
 
+    // 异步日志：logAll 只把参数拷进本线程的环形缓冲区，由后台线程格式化后批量写出
+    logging::async_options options;
+    options.ring_slots = 256;
+    options.overflow = logging::overflow_policy::drop;
+    logging::start_async(options);
+    int value = 42;
+    const char* text = "Hello Async!";
+    std::string owned = "Hello String!";
+    logAll(value, text, owned);
+    Logger<double>::log(3.14);
+    // 每个线程写进自己的环；记录远少于 256 个槽，drop 策略不会触发。
+    // 线程依次运行，示例输出的顺序是固定的
+    for (int t = 0; t < 4; ++t) {
+        std::thread([t] {
+            for (int i = 0; i < 3; ++i) {
+                logAll(t, i);
+            }
+        }).join();
+    }
+    logging::flush();
+    logging::stop_async();
+    logAll(std::string("back to synchronous logging"));
+
+    // 二进制日志：站点文本和参数类型只登记一次，每条记录只有站点编号和紧凑编码的参数，
+    // 用 bin/logdecode <path> 还原成与上面相同格式的文本
+    options.overflow = logging::overflow_policy::block;
+    options.binary_path = (scratch / "metaprogram.tlog").string();
+    logging::start_async(options);
+    logging::binlog<"request served">(value, text, owned, 2.5);
+    for (int i = 0; i < 1000; ++i) {
+        logging::binlog<"tick">(i, static_cast<unsigned long>(i) * 3);
+    }
+    logAll(value, text);
+    logKV("user"_key, value, "path"_key, text, "latency_us"_key, 17.5);
+    logging::stop_async();
+    std::cout << "binary log written to " << options.binary_path << std::endl;
+
+    // 共享内存传输：格式化和落盘交给另一个进程，
+    // 用 bin/logcollect metaprogram metaprogram.txt --once 取出；共享内存对象不随进程消失，用完要删除
+    options.binary_path.clear();
+    options.shm_name = "metaprogram";
+    options.shm_bytes = std::size_t(1) << 16;
+    logging::start_async(options);
+    for (int i = 0; i < 100; ++i) {
+        logging::binlog<"shared">(i, owned);
+    }
+    logging::stop_async();
+    logging::shm_ring::unlink(options.shm_name);
+    std::cout << "shared memory ring " << options.shm_name << " written and removed" << std::endl;
+
+    // 日志级别：Release 构建里 debug 调用在编译期整段去掉，运行期阈值可以随时无锁调整
+    logAll<logging::severity::debug>(std::string("debug: only in debug builds"));
+    logging::set_threshold(logging::severity::warn);
+    Logger<int>::log(value); // info 低于运行期阈值，不输出
+    Logger<int>::log<logging::severity::error>(value);
+    logging::when<logging::severity::debug>([&] { logAll<logging::severity::debug>(Sum<1, 2, 3>::value); });
+    logging::set_threshold(logging::min_severity);
+
+    // 输出端缓冲：size 策略下这些行先攒在缓冲区里，flush 时一次写出
+    logging::sink_options sink;
+    sink.policy = logging::flush_policy::size;
+    logging::configure_sink(sink);
+    for (int i = 0; i < 100; ++i) {
+        Logger<int>::log(i);
+    }
+    logging::flush();
+    logging::configure_sink(logging::sink_options{});
+
+    // 内存映射的滚动文件：每行只是一次原子占位加 memcpy，换段、msync 都在后台线程
+    logging::mapped_file_options file_options;
+    file_options.path = (scratch / "metaprogram.log").string();
+    file_options.segment_bytes = std::size_t(1) << 20;
+    logging::sink_options mapped;
+    mapped.file = logging::mapped_file::open(file_options);
+    logging::configure_sink(mapped);
+    for (int i = 0; i < 1000; ++i) {
+        logAll(i, text);
+    }
+    logging::configure_sink(logging::sink_options{});
+    mapped.file->close();
+
+    std::cout << "mapped log written to " << mapped.file->first_segment() << std::endl;
+
+    // io_uring 文件：调用线程只拷进注册过的缓冲池，后台线程批量提交写入并回收缓冲区；
+    // 内核不支持 io_uring 时由后台线程 pwrite
+    logging::uring_file_options uring_options;
+    uring_options.path = (scratch / "metaprogram.uring.log").string();
+    logging::sink_options uring_sink;
+    uring_sink.uring = logging::uring_file::open(uring_options);
+    logging::configure_sink(uring_sink);
+    for (int i = 0; i < 1000; ++i) {
+        logAll(i, text);
+    }
+    logging::configure_sink(logging::sink_options{});
+    uring_sink.uring->close();
+    std::cout << "uring log written to " << uring_options.path << " ("
+              << (uring_sink.uring->backend() == logging::uring_backend::io_uring ? "io_uring" : "pwrite thread") << ")"
+              << std::endl;
+
+    // 按调用点限流：热循环里每 1000 次只输出一次，令牌桶每秒最多 10 条、可连发 3 条，
+    // flush 时每个站点汇总一行 "suppressed K messages"
+    for (int i = 0; i < 5000; ++i) {
+        logging::throttled<"hot loop", logging::sample<1000>>(i);
+        logging::throttled<"retry", logging::rate<10, 3>>(std::string("retrying"));
+    }
+    logging::flush();
+
+    // 结构化日志：键在编译期确定，值按类型渲染，下游不必再解析自由文本
+    logKV("user"_key, value, "path"_key, text, "latency_us"_key, 17.5);
+    logging::set_kv_format(logging::kv_format::json);
+    logKV<logging::severity::warn>("user"_key, owned, "retries"_key, 3u, "ok"_key, false);
+    logging::set_kv_format(logging::kv_format::text);
+
+    // 类型安全的格式化：格式串在编译期切成文本块和参数槽，'%' 个数与参数不符时编译失败
+    safefmt::print<"Value: %, Message: %\n">(42, "Success");
+    std::cout << safefmt::format<"%: % of % served (100%%) in % us\n">(owned, value, 42u, 17.5);
+
+    std::filesystem::remove_all(scratch);
+
     // Example usage of Fibonacci
     // constexpr int fib10 = Fibonacci<15>::value;
     // constexpr int fib20 = Fibonacci<20>::value;
@@ -0,0 +1,572 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "expr.h"
+#include "simd_reduce.h"
+#include "thread_pool.h"
+
+// 1. 检测类型是否支持加法
+template <typename T, typename = void>
+struct is_addable : std::false_type {};
+
+template <typename T>
+struct is_addable<T, decltype(void(std::declval<T>() + std::declval<T>()))> : std::true_type {};
+
+// 字符串拼接：参数全部能转换成 std::string_view（std::string / std::string_view /
+// const char* / 字符数组），且至少有一个 std::string 时，走下面的一次分配版本
+template <typename T>
+inline constexpr bool is_string_piece_v = std::is_convertible_v<const std::remove_reference_t<T>&, std::string_view>;
+
+template <typename... Args>
+inline constexpr bool is_string_concat_v =
+    (is_string_piece_v<Args> && ...) && (std::is_same_v<std::decay_t<Args>, std::string> || ...);
+
+// 参数全部是表达式模板类型（expr::vector 或继承 expr::expression 的自定义数组）时，
+// 走下面的融合版本：整个参数包只求值一次，没有中间数组
+template <typename... Args>
+inline constexpr bool is_expr_fold_v = sizeof...(Args) > 0 && (expr::is_expression_v<std::decay_t<Args>> && ...);
+
+template <typename... Args>
+inline constexpr bool is_generic_fold_v = !is_string_concat_v<Args...> && !is_expr_fold_v<Args...>;
+
+// 2. 可变参数加法的实现
+template <typename T, typename... Args, std::enable_if_t<is_generic_fold_v<T, Args...>, int> = 0>
+constexpr auto add(T first, Args... args) {
+    // 确保所有类型相同且支持加法
+    static_assert(is_addable<T>::value, "Type must be addable");
+    static_assert((std::is_same_v<T, Args> && ...), "All types must be the same");
+
+    if constexpr (sizeof...(args) == 0) {
+        return first;
+    } else {
+        return first + add(args...);
+    }
+}
+
+// 折叠表达式实现（C++17）
+template <typename... Args, std::enable_if_t<is_generic_fold_v<Args...>, int> = 0>
+constexpr auto add_fold(Args... args) {
+    // 确保至少有一个参数且所有类型相同
+    static_assert(sizeof...(args) > 0, "At least one argument is required");
+    using CommnType = std::common_type_t<Args...>;
+
+    // 确保支持加法
+    static_assert(is_addable<CommnType>::value, "Type must be addable");
+    
+    // 使用折叠表达式进行加法
+    return (... + args); 
+}
+
+namespace detail {
+
+// 先累计总长度只 reserve 一次，再逐段 append；out 已有的内容和容量都保留
+inline void append_all(std::string& out, std::initializer_list<std::string_view> pieces) {
+    std::size_t total = out.size();
+    for (std::string_view piece : pieces) {
+        total += piece.size();
+    }
+    out.reserve(total);
+    for (std::string_view piece : pieces) {
+        out.append(piece);
+    }
+}
+
+// 第一个参数是 std::string 右值时直接接管它的缓冲区
+template <typename First, typename... Rest>
+std::string concat_strings(First&& first, const Rest&... rest) {
+    if constexpr (!std::is_reference_v<First> && std::is_same_v<std::remove_cv_t<First>, std::string>) {
+        std::string result(std::move(first));
+        append_all(result, {std::string_view(rest)...});
+        return result;
+    } else {
+        std::string result;
+        append_all(result, {std::string_view(first), std::string_view(rest)...});
+        return result;
+    }
+}
+
+} // namespace detail
+
+// 字符串版本：add(s1, s2, s3) / add(std::move(s), "-", sv)，只分配一次、没有中间临时串。
+// 拼接满足结合律，所以 add 与 add_fold 结果相同
+template <typename First, typename... Rest, std::enable_if_t<is_string_concat_v<First, Rest...>, int> = 0>
+std::string add(First&& first, Rest&&... rest) {
+    return detail::concat_strings(std::forward<First>(first), rest...);
+}
+
+template <typename First, typename... Rest, std::enable_if_t<is_string_concat_v<First, Rest...>, int> = 0>
+std::string add_fold(First&& first, Rest&&... rest) {
+    return detail::concat_strings(std::forward<First>(first), rest...);
+}
+
+// 检测类型是否支持减法
+template <typename T, typename = void>
+struct is_subable : std::false_type {};
+
+template <typename T>
+struct is_subable<T, decltype(void(std::declval<T>() - std::declval<T>()))> : std::true_type {};
+
+// 可变参数减法的实现
+template <typename T, typename... Args, std::enable_if_t<!is_expr_fold_v<T, Args...>, int> = 0>
+constexpr auto sub(T first, Args... args) {
+    static_assert(is_subable<T>::value, "Type must be subable");
+    static_assert((std::is_same_v<T, Args> && ...), "All types must be the same");
+    if constexpr (sizeof...(args) == 0) {
+        return first;
+    } else {
+        return first - sub(args...);
+    }
+}
+
+// 折叠表达式实现的减法
+template <typename... Args, std::enable_if_t<!is_expr_fold_v<Args...>, int> = 0>
+constexpr auto sub_fold(Args... args) {
+    static_assert(sizeof...(args) > 0, "At least one argument is required");
+    using CommonType = std::common_type_t<Args...>;
+
+    static_assert(is_subable<CommonType>::value, "Type must be subable");
+
+    // 左折叠表达式进行减法
+    return (... - args);
+}
+
+// 表达式模板版本：参数按引用传入，先用与上面相同的结合方向拼出惰性表达式树，
+// 再一次性写入第一个参数类型的结果，逐元素只遍历一遍
+template <typename T, typename... Args, std::enable_if_t<is_expr_fold_v<T, Args...>, int> = 0>
+T add(const T& first, const Args&... args) {
+    static_assert(is_addable<T>::value, "Type must be addable");
+    static_assert((std::is_same_v<T, Args> && ...), "All types must be the same");
+    if constexpr (sizeof...(args) == 0) {
+        return first;
+    } else {
+        return expr::evaluate<T>(first + (args + ...));
+    }
+}
+
+template <typename T, typename... Args, std::enable_if_t<is_expr_fold_v<T, Args...>, int> = 0>
+T add_fold(const T& first, const Args&... args) {
+    static_assert(is_addable<T>::value, "Type must be addable");
+    if constexpr (sizeof...(args) == 0) {
+        return first;
+    } else {
+        return expr::evaluate<T>((first + ... + args));
+    }
+}
+
+template <typename T, typename... Args, std::enable_if_t<is_expr_fold_v<T, Args...>, int> = 0>
+T sub(const T& first, const Args&... args) {
+    static_assert(is_subable<T>::value, "Type must be subable");
+    static_assert((std::is_same_v<T, Args> && ...), "All types must be the same");
+    if constexpr (sizeof...(args) == 0) {
+        return first;
+    } else {
+        return expr::evaluate<T>(first - (args - ...));
+    }
+}
+
+template <typename T, typename... Args, std::enable_if_t<is_expr_fold_v<T, Args...>, int> = 0>
+T sub_fold(const T& first, const Args&... args) {
+    static_assert(is_subable<T>::value, "Type must be subable");
+    if constexpr (sizeof...(args) == 0) {
+        return first;
+    } else {
+        return expr::evaluate<T>((first - ... - args));
+    }
+}
+
+// 连续区间重载：std::vector / std::array / std::span / 原生数组等
+// 要求 std::data 返回指针且 std::size 可用
+template <typename R, typename = void>
+struct is_contiguous_range : std::false_type {};
+
+template <typename R>
+struct is_contiguous_range<R, std::void_t<decltype(std::data(std::declval<R&>())),
+                                          decltype(std::size(std::declval<R&>()))>>
+    : std::is_pointer<decltype(std::data(std::declval<R&>()))> {};
+
+template <typename R>
+using contiguous_value_t = std::remove_cv_t<std::remove_pointer_t<decltype(std::data(std::declval<R&>()))>>;
+
+// 本身可加的类型（如 std::string）仍按值折叠，只有"整体不可加"的区间才按元素归约
+template <typename R>
+inline constexpr bool is_range_fold_v = is_contiguous_range<R>::value && !is_addable<R>::value;
+
+// 区间求和：元素类型有向量内核时走 simd::sum，std::string 一次 reserve 后拼接，
+// 否则按顺序左折叠；空区间返回值初始化的元素
+template <typename R, std::enable_if_t<is_range_fold_v<R>, int> = 0>
+auto add_fold(const R& range) {
+    using T = contiguous_value_t<R>;
+    static_assert(is_addable<T>::value, "Type must be addable");
+
+    const T* p = std::data(range);
+    const std::size_t n = std::size(range);
+    if constexpr (simd::has_kernel_v<T>) {
+        return simd::sum(p, n);
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        std::string total;
+        std::size_t length = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            length += p[i].size();
+        }
+        total.reserve(length);
+        for (std::size_t i = 0; i < n; ++i) {
+            total.append(p[i]);
+        }
+        return total;
+    } else {
+        if (n == 0) {
+            return T{};
+        }
+        T total = p[0];
+        for (std::size_t i = 1; i < n; ++i) {
+            total = total + p[i];
+        }
+        return total;
+    }
+}
+
+// 区间减法：r[0] - r[1] - ... - r[n-1]
+// 有向量内核时按 r[0] - (r[1] + ... + r[n-1]) 计算，浮点舍入与严格左折叠可能不同
+template <typename R, std::enable_if_t<is_range_fold_v<R>, int> = 0>
+auto sub_fold(const R& range) {
+    using T = contiguous_value_t<R>;
+    static_assert(is_subable<T>::value, "Type must be subable");
+
+    const T* p = std::data(range);
+    const std::size_t n = std::size(range);
+    if (n == 0) {
+        return T{};
+    }
+    if constexpr (simd::has_kernel_v<T>) {
+        return simd::lane_sub(p[0], simd::sum(p + 1, n - 1));
+    } else {
+        T total = p[0];
+        for (std::size_t i = 1; i < n; ++i) {
+            total = total - p[i];
+        }
+        return total;
+    }
+}
+
+// 带求和策略的版本：add<sum_mode::neumaier>(...) / add_fold<sum_mode::reproducible>(range)
+// 参数包按从左到右的顺序参与运算；非浮点类型的求和是精确的，策略不起作用
+using simd::sum_mode;
+
+template <sum_mode M, typename... Args>
+constexpr auto add_fold(Args... args) {
+    static_assert(sizeof...(args) > 0, "At least one argument is required");
+    using CommonType = std::common_type_t<Args...>;
+    static_assert(is_addable<CommonType>::value, "Type must be addable");
+
+    if constexpr (std::is_floating_point_v<CommonType>) {
+        const CommonType values[] = {static_cast<CommonType>(args)...};
+        return simd::scalar::sum<M>(values, sizeof...(args));
+    } else {
+        return (... + args);
+    }
+}
+
+template <sum_mode M, typename T, typename... Args>
+constexpr auto add(T first, Args... args) {
+    static_assert(is_addable<T>::value, "Type must be addable");
+    static_assert((std::is_same_v<T, Args> && ...), "All types must be the same");
+    return add_fold<M>(first, args...);
+}
+
+// 可复现模式下，区间与同样元素组成的参数包结果逐位相同
+template <sum_mode M, typename R, std::enable_if_t<is_range_fold_v<R>, int> = 0>
+auto add_fold(const R& range) {
+    using T = contiguous_value_t<R>;
+    static_assert(is_addable<T>::value, "Type must be addable");
+
+    if constexpr (simd::has_kernel_v<T> || std::is_floating_point_v<T>) {
+        return simd::sum(std::data(range), std::size(range), M);
+    } else {
+        return add_fold(range);
+    }
+}
+
+// 指定累加器个数：add_fold<unroll<8>>(range)。默认的 add_fold(range) 已按指令集选好个数，
+// 这里用于在具体硬件上调优；浮点结果随 K 变化（与 naive 策略一样只是舍入顺序不同）
+using simd::unroll;
+
+template <typename U, typename R, std::enable_if_t<simd::is_unroll<U>::value && is_range_fold_v<R>, int> = 0>
+auto add_fold(const R& range) {
+    using T = contiguous_value_t<R>;
+    static_assert(is_addable<T>::value, "Type must be addable");
+    static_assert(simd::has_kernel_v<T>, "Element type must be arithmetic");
+    return simd::sum_unrolled<U::accumulators>(std::data(range), std::size(range));
+}
+
+// 整数溢出检查：add_fold<overflow_mode::checked>(...) / sub_fold<overflow_mode::saturating>(range)
+// 所有步骤都在 128 位精确累加器上进行，不会出现有符号溢出的未定义行为。
+// 只看最终的精确结果：中间步骤越界、最后又回到范围内不算溢出
+using simd::overflow_mode;
+
+template <typename T>
+struct checked_result {
+    T value;       // 按补码回绕后的结果
+    bool overflow; // 精确结果超出 T 的范围
+};
+
+namespace detail {
+
+template <typename... Args>
+inline constexpr bool is_overflow_fold_v =
+    std::is_integral_v<std::common_type_t<Args...>> && !std::is_same_v<std::common_type_t<Args...>, bool>;
+
+template <overflow_mode M, typename T>
+constexpr auto finish_exact(const simd::wide_sum& total) {
+    if constexpr (M == overflow_mode::checked) {
+        return checked_result<T>{total.template wrapped<T>(), !total.template fits<T>()};
+    } else if constexpr (M == overflow_mode::saturating) {
+        return total.template saturated<T>();
+    } else {
+        return total.template wrapped<T>();
+    }
+}
+
+} // namespace detail
+
+template <overflow_mode M, typename... Args>
+constexpr auto add_fold(Args... args) {
+    static_assert(sizeof...(args) > 0, "At least one argument is required");
+    static_assert(detail::is_overflow_fold_v<Args...>, "Overflow modes require an integral type");
+    using CommonType = std::common_type_t<Args...>;
+
+    simd::wide_sum total;
+    (total.add(static_cast<CommonType>(args)), ...);
+    return detail::finish_exact<M, CommonType>(total);
+}
+
+template <overflow_mode M, typename T, typename... Args>
+constexpr auto add(T first, Args... args) {
+    static_assert((std::is_same_v<T, Args> && ...), "All types must be the same");
+    return add_fold<M>(first, args...);
+}
+
+// 左折叠 ((a - b) - c) - d = a - (b + c + d)
+template <overflow_mode M, typename... Args>
+constexpr auto sub_fold(Args... args) {
+    static_assert(sizeof...(args) > 0, "At least one argument is required");
+    static_assert(detail::is_overflow_fold_v<Args...>, "Overflow modes require an integral type");
+    using CommonType = std::common_type_t<Args...>;
+
+    const CommonType values[] = {static_cast<CommonType>(args)...};
+    simd::wide_sum total;
+    simd::wide_sum rest;
+    total.add(values[0]);
+    for (std::size_t i = 1; i < sizeof...(args); ++i) {
+        rest.add(values[i]);
+    }
+    total.sub(rest);
+    return detail::finish_exact<M, CommonType>(total);
+}
+
+// 右折叠 a - (b - (c - d)) = a - b + c - d
+template <overflow_mode M, typename T, typename... Args>
+constexpr auto sub(T first, Args... args) {
+    static_assert(detail::is_overflow_fold_v<T>, "Overflow modes require an integral type");
+    static_assert((std::is_same_v<T, Args> && ...), "All types must be the same");
+
+    const T values[] = {first, args...};
+    simd::wide_sum plus;
+    simd::wide_sum minus;
+    for (std::size_t i = 0; i <= sizeof...(args); ++i) {
+        (i % 2 == 0 ? plus : minus).add(values[i]);
+    }
+    plus.sub(minus);
+    return detail::finish_exact<M, T>(plus);
+}
+
+// 区间版本：逐 lane 回绕累加并统计回绕次数，整段只在最后判断一次是否溢出
+template <overflow_mode M, typename R, std::enable_if_t<is_range_fold_v<R>, int> = 0>
+auto add_fold(const R& range) {
+    using T = contiguous_value_t<R>;
+    static_assert(detail::is_overflow_fold_v<T>, "Overflow modes require an integral type");
+
+    if constexpr (M == overflow_mode::wrap) {
+        return add_fold(range);
+    } else {
+        return detail::finish_exact<M, T>(simd::exact_sum(std::data(range), std::size(range)));
+    }
+}
+
+template <overflow_mode M, typename R, std::enable_if_t<is_range_fold_v<R>, int> = 0>
+auto sub_fold(const R& range) {
+    using T = contiguous_value_t<R>;
+    static_assert(detail::is_overflow_fold_v<T>, "Overflow modes require an integral type");
+
+    const T* p = std::data(range);
+    const std::size_t n = std::size(range);
+    if constexpr (M == overflow_mode::wrap) {
+        return sub_fold(range);
+    } else {
+        simd::wide_sum total;
+        if (n > 0) {
+            total.add(p[0]);
+            total.sub(simd::exact_sum(p + 1, n - 1));
+        }
+        return detail::finish_exact<M, T>(total);
+    }
+}
+
+// 多线程区间求和的配置
+//   threads : 线程数（含调用线程），0 表示全部逻辑核
+//   grain   : 每个任务负责的元素个数；分块只取决于 grain，不取决于线程数
+//   pin     : 工作线程是否绑定到各自的逻辑核
+//   mode    : 与 add_fold<M>(range) 相同的求和策略
+//   pool    : 非空时使用调用方的线程池，忽略 threads / pin
+struct parallel_policy {
+    std::size_t threads = 0;
+    std::size_t grain = std::size_t(1) << 16;
+    bool pin = false;
+    sum_mode mode = sum_mode::naive;
+    par::thread_pool* pool = nullptr;
+};
+
+namespace detail {
+
+// 按下标两两合并各块的部分和；整数按回绕加法，与单线程内核一致
+template <typename T>
+T combine_partials(const T* p, std::size_t n) {
+    if (n == 1) {
+        return p[0];
+    }
+    const std::size_t half = n / 2;
+    return simd::lane_add(combine_partials(p, half), combine_partials(p + half, n - half));
+}
+
+} // namespace detail
+
+// 把区间按 grain 切块分给线程池，每块用向量内核归约，部分和按固定的树形顺序合并。
+// 结果只取决于数据、grain 和 mode，与线程数无关；reproducible 模式与单线程
+// add_fold<sum_mode::reproducible>(range) 逐位相同
+template <typename R, std::enable_if_t<is_range_fold_v<R>, int> = 0>
+auto parallel_add_fold(const R& range, const parallel_policy& policy = {}) {
+    using T = contiguous_value_t<R>;
+    static_assert(is_addable<T>::value, "Type must be addable");
+    static_assert(simd::has_kernel_v<T> || std::is_floating_point_v<T>, "Element type must be arithmetic");
+
+    const T* p = std::data(range);
+    const std::size_t n = std::size(range);
+    const simd::level lvl = simd::runtime_level();
+    // 共享池由这里持有到函数返回，别的线程换了配置也不会在归约中途析构它
+    const std::shared_ptr<par::thread_pool> shared = policy.pool ? nullptr : par::shared_pool(policy.threads, policy.pin);
+    par::thread_pool& pool = policy.pool ? *policy.pool : *shared;
+
+    if constexpr (std::is_floating_point_v<T>) {
+        if (policy.mode == sum_mode::reproducible) {
+            // 每个任务负责若干完整的可复现块，块结果存下来后沿串行版本的同一棵树合并
+            constexpr std::size_t block = simd::repro_block;
+            const std::size_t blocks = (n + block - 1) / block;
+            const std::size_t per_task = policy.grain > block ? policy.grain / block : 1;
+            std::vector<simd::compensated<T>> leaves(blocks);
+            pool.run((blocks + per_task - 1) / per_task, [&](std::size_t task) {
+                const std::size_t last = (task + 1) * per_task < blocks ? (task + 1) * per_task : blocks;
+                for (std::size_t b = task * per_task; b < last; ++b) {
+                    const std::size_t len = n - b * block < block ? n - b * block : block;
+                    if constexpr (simd::has_kernel_v<T>) {
+                        leaves[b] = simd::repro_leaf(p + b * block, len, lvl);
+                    } else {
+                        leaves[b] = simd::scalar::repro_leaf(p + b * block, len);
+                    }
+                }
+            });
+            return simd::repro_sum(p, n, [&](const T* q, std::size_t) { return leaves[(q - p) / block]; });
+        }
+    }
+
+    const std::size_t grain = policy.grain == 0 ? 1 : policy.grain;
+    const std::size_t chunks = (n + grain - 1) / grain;
+    if (chunks <= 1) {
+        return simd::sum(p, n, policy.mode, lvl);
+    }
+    std::vector<T> partials(chunks);
+    pool.run(chunks, [&](std::size_t c) {
+        const std::size_t begin = c * grain;
+        const std::size_t len = n - begin < grain ? n - begin : grain;
+        partials[c] = simd::sum(p + begin, len, policy.mode, lvl);
+    });
+    if constexpr (std::is_floating_point_v<T>) {
+        if (policy.mode == sum_mode::neumaier) {
+            return simd::scalar::neumaier(partials.data(), chunks);
+        }
+    }
+    return detail::combine_partials(partials.data(), chunks);
+}
+
+// 平衡树版本：参数先放进数组，再按下标两两分治。
+// 模板只按参数包实例化一次，不再像 add / sub 那样每个参数实例化一层，
+// 常量求值的递归深度也只有 O(log N)，几百上千个参数不会撞上 -ftemplate-depth
+namespace detail {
+
+template <typename T>
+constexpr T add_tree_range(const T* p, std::size_t n) {
+    if (n == 1) {
+        return p[0];
+    }
+    const std::size_t half = n / 2;
+    return add_tree_range(p, half) + add_tree_range(p + half, n - half);
+}
+
+// 右折叠 a - (b - (c - d)) 展开后是 a - b + c - d：
+// 左半段长度为偶数时右半段整体取正号，为奇数时取负号
+template <typename T>
+constexpr T sub_tree_range(const T* p, std::size_t n) {
+    if (n == 1) {
+        return p[0];
+    }
+    const std::size_t half = n / 2;
+    if (half % 2 == 0) {
+        return sub_tree_range(p, half) + sub_tree_range(p + half, n - half);
+    }
+    return sub_tree_range(p, half) - sub_tree_range(p + half, n - half);
+}
+
+} // namespace detail
+
+// 与 add 结果相同（整数完全一致，浮点只有舍入顺序不同）
+template <typename T, typename... Args>
+constexpr auto add_tree(T first, Args... args) {
+    static_assert(is_addable<T>::value, "Type must be addable");
+    static_assert((std::is_same_v<T, Args> && ...), "All types must be the same");
+
+    const T values[] = {first, args...};
+    return detail::add_tree_range(values, 1 + sizeof...(args));
+}
+
+// 与 sub 的右折叠语义相同：a - (b - (c - d))
+template <typename T, typename... Args>
+constexpr auto sub_tree(T first, Args... args) {
+    static_assert(is_subable<T>::value, "Type must be subable");
+    static_assert(is_addable<T>::value, "Type must be addable");
+    static_assert((std::is_same_v<T, Args> && ...), "All types must be the same");
+
+    const T values[] = {first, args...};
+    return detail::sub_tree_range(values, 1 + sizeof...(args));
+}
+
+// 与 sub_fold 的左折叠语义相同：((a - b) - c) - d = a - (b + c + d)
+template <typename T, typename... Args>
+constexpr auto sub_fold_tree(T first, Args... args) {
+    static_assert(is_subable<T>::value, "Type must be subable");
+    static_assert((std::is_same_v<T, Args> && ...), "All types must be the same");
+
+    if constexpr (sizeof...(args) == 0) {
+        return first;
+    } else {
+        static_assert(is_addable<T>::value, "Type must be addable");
+        const T rest[] = {args...};
+        return first - detail::add_tree_range(rest, sizeof...(args));
+    }
+}
@@ -0,0 +1,114 @@
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// 编译期基准：为不同大小的参数包生成源文件，分别用递归版 add / sub 与平衡树版
+// add_tree / sub_tree 编译，统计编译耗时和目标文件中的函数模板实例个数。
+// 编译器路径和头文件目录由 CMake 传入（BENCH_CXX / BENCH_INCLUDE_DIR）
+
+namespace fs = std::filesystem;
+
+struct Result {
+    bool ok = false;
+    double seconds = 0;
+    int instantiations = 0;
+};
+
+// 生成 int run(const int* v) { return fn(v[0], ..., v[n - 1]); }
+std::string make_source(const char* fn, int n) {
+    std::string src = "#include \"add_sub.h\"\nint run(const int* v) {\n    return ";
+    src += fn;
+    src += "(";
+    for (int i = 0; i < n; ++i) {
+        if (i != 0) {
+            src += ", ";
+        }
+        src += "v[" + std::to_string(i) + "]";
+    }
+    src += ");\n}\n";
+    return src;
+}
+
+// -O0 下每个用到的函数模板实例都会留下一个符号，以此近似实例化次数。
+// 参数包很大时 nm -C 会放弃反修饰，所以直接匹配修饰名前缀：
+// fn<...> 为 _Z<len>fnI，detail::fn_range<...> 为 _ZN6detail<len>fn_rangeI
+int count_instantiations(const fs::path& object, const char* fn) {
+    const std::string cmd = "nm \"" + object.string() + "\"";
+    FILE* pipe = popen(cmd.c_str(), "r");
+    if (!pipe) {
+        return -1;
+    }
+    const std::string name(fn);
+    const std::string range = name + "_range";
+    const std::string plain = " _Z" + std::to_string(name.size()) + name + "I";
+    const std::string detail = " _ZN6detail" + std::to_string(range.size()) + range + "I";
+    int count = 0;
+    // 符号名远超任何固定缓冲区，按字符拼出完整的一行再匹配
+    std::string s;
+    for (int c = std::fgetc(pipe); c != EOF; c = std::fgetc(pipe)) {
+        if (c != '\n') {
+            s += static_cast<char>(c);
+            continue;
+        }
+        if (s.find(plain) != std::string::npos || s.find(detail) != std::string::npos) {
+            ++count;
+        }
+        s.clear();
+    }
+    pclose(pipe);
+    return count;
+}
+
+Result compile(const fs::path& dir, const char* fn, int n, const std::string& extra_flags) {
+    const fs::path source = dir / (std::string(fn) + "_" + std::to_string(n) + ".cpp");
+    const fs::path object = dir / (std::string(fn) + "_" + std::to_string(n) + ".o");
+    std::ofstream(source) << make_source(fn, n);
+
+    const std::string cmd = std::string(BENCH_CXX) + " -std=c++20 -O0 -c " + extra_flags + " -I\"" +
+                            BENCH_INCLUDE_DIR + "\" \"" + source.string() + "\" -o \"" + object.string() +
+                            "\" > /dev/null 2>&1";
+    Result r;
+    auto start = std::chrono::steady_clock::now();
+    r.ok = std::system(cmd.c_str()) == 0;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    r.seconds = elapsed.count();
+    if (r.ok) {
+        r.instantiations = count_instantiations(object, fn);
+    }
+    return r;
+}
+
+void print_cell(const Result& r) {
+    if (r.ok) {
+        std::printf(" %6d %8.2fs |", r.instantiations, r.seconds);
+    } else {
+        std::printf(" %15s |", "FAILED");
+    }
+}
+
+int main() {
+    const fs::path dir = fs::temp_directory_path() / "template_compile_bench";
+    fs::create_directories(dir);
+
+    std::printf("compiler: %s\n", BENCH_CXX);
+    std::printf("递归版使用默认 -ftemplate-depth 时的表现，以及放宽深度限制后的代价：\n\n");
+    std::printf("%6s | %-15s | %-15s | %-15s | %-15s | %-15s\n", "N", "add (default)", "add (deep)",
+                "add_tree", "sub (deep)", "sub_tree");
+    std::printf("%6s | %6s %9s | %6s %9s | %6s %9s | %6s %9s | %6s %9s\n", "", "inst", "time", "inst", "time",
+                "inst", "time", "inst", "time", "inst", "time");
+    for (int n = 8; n <= 4096; n *= 2) {
+        const std::string deep = "-ftemplate-depth=" + std::to_string(n + 64);
+        std::printf("%6d |", n);
+        print_cell(compile(dir, "add", n, ""));
+        print_cell(compile(dir, "add", n, deep));
+        print_cell(compile(dir, "add_tree", n, ""));
+        print_cell(compile(dir, "sub", n, deep));
+        print_cell(compile(dir, "sub_tree", n, ""));
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+    fs::remove_all(dir);
+    return 0;
+}
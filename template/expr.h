@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// 逐元素运算的表达式模板：a + b - c 只构造一棵惰性的表达式树，
+// 赋值给具体容器时才按下标一次性求值，中间不产生任何临时数组。
+//
+// 自定义类型接入方式：公有继承 expr::expression<Derived>，并提供
+//   std::size_t size() const;
+//   value operator[](std::size_t) const;  以及可写的 operator[]
+//   Derived(std::size_t n) 或默认构造（定长类型）
+// operator+ / operator- 通过基类所在命名空间的 ADL 找到，因此 is_addable / is_subable 仍然成立
+namespace expr {
+
+template <typename Derived>
+struct expression {
+    const Derived& self() const { return static_cast<const Derived&>(*this); }
+};
+
+template <typename T>
+inline constexpr bool is_expression_v = std::is_base_of_v<expression<T>, T>;
+
+template <typename L, typename R, typename Op>
+class binary_expr;
+
+// 表达式节点是运算符返回的临时对象，按值保存；叶子（真正的容器）按引用保存
+template <typename T>
+struct is_node : std::false_type {};
+
+template <typename L, typename R, typename Op>
+struct is_node<binary_expr<L, R, Op>> : std::true_type {};
+
+template <typename T>
+using operand_t = std::conditional_t<is_node<T>::value, const T, const T&>;
+
+template <typename L, typename R, typename Op>
+class binary_expr : public expression<binary_expr<L, R, Op>> {
+public:
+    binary_expr(const L& l, const R& r) : l_(l), r_(r) {
+        assert(l.size() == r.size() && "operands must have the same size");
+    }
+
+    std::size_t size() const { return l_.size(); }
+
+    auto operator[](std::size_t i) const { return Op{}(l_[i], r_[i]); }
+
+private:
+    operand_t<L> l_;
+    operand_t<R> r_;
+};
+
+template <typename L, typename R, std::enable_if_t<is_expression_v<L> && is_expression_v<R>, int> = 0>
+binary_expr<L, R, std::plus<>> operator+(const L& l, const R& r) {
+    return {l, r};
+}
+
+template <typename L, typename R, std::enable_if_t<is_expression_v<L> && is_expression_v<R>, int> = 0>
+binary_expr<L, R, std::minus<>> operator-(const L& l, const R& r) {
+    return {l, r};
+}
+
+// 把表达式一次性写入 D 类型的结果，这是整个计算中唯一的一次遍历和唯一的一块新内存
+template <typename D, typename E>
+D evaluate(const expression<E>& e) {
+    const E& x = e.self();
+    if constexpr (std::is_constructible_v<D, const E&>) {
+        return D(x);
+    } else {
+        const std::size_t n = x.size();
+        D out = [n] {
+            if constexpr (std::is_constructible_v<D, std::size_t>) {
+                return D(n);
+            } else {
+                return D{};
+            }
+        }();
+        assert(out.size() == n && "result size does not match the expression");
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = x[i];
+        }
+        return out;
+    }
+}
+
+// 只做默认初始化的分配器：结果缓冲区随后会被表达式整体覆盖，省掉 std::vector 的清零遍历
+template <typename T>
+struct default_init_allocator : std::allocator<T> {
+    template <typename U>
+    struct rebind {
+        using other = default_init_allocator<U>;
+    };
+
+    default_init_allocator() = default;
+    template <typename U>
+    default_init_allocator(const default_init_allocator<U>&) noexcept {}
+
+    template <typename U>
+    void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new (static_cast<void*>(p)) U;
+    }
+
+    template <typename U, typename... A>
+    void construct(U* p, A&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<A>(args)...);
+    }
+};
+
+// 自带的动态数组，构造或赋值自任意表达式时融合成一个循环
+template <typename T>
+class vector : public expression<vector<T>> {
+public:
+    using value_type = T;
+
+    vector() = default;
+    explicit vector(std::size_t n, T value = T{}) : data_(n, value) {}
+    vector(std::initializer_list<T> values) : data_(values) {}
+
+    template <typename E, std::enable_if_t<is_node<E>::value, int> = 0>
+    vector(const E& e) : data_(e.size()) {
+        assign(e);
+    }
+
+    // 逐下标写回，a = a + b 这类与自身重叠的表达式也是安全的
+    template <typename E, std::enable_if_t<is_node<E>::value, int> = 0>
+    vector& operator=(const E& e) {
+        data_.resize(e.size());
+        assign(e);
+        return *this;
+    }
+
+    std::size_t size() const { return data_.size(); }
+    T& operator[](std::size_t i) { return data_[i]; }
+    const T& operator[](std::size_t i) const { return data_[i]; }
+    T* data() { return data_.data(); }
+    const T* data() const { return data_.data(); }
+    auto begin() { return data_.begin(); }
+    auto end() { return data_.end(); }
+    auto begin() const { return data_.begin(); }
+    auto end() const { return data_.end(); }
+
+private:
+    template <typename E>
+    void assign(const E& e) {
+        T* out = data_.data();
+        const std::size_t n = data_.size();
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = e[i];
+        }
+    }
+
+    std::vector<T, default_init_allocator<T>> data_;
+};
+
+} // namespace expr
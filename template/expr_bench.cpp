@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "add_sub.h"
+
+// 表达式模板与逐步求值的对比：add(a, b, c, d) 与 sub_fold(a, b, c)
+// eager 版本每做一次 + / - 就分配并写出一个完整的临时数组，
+// expr::vector 版本只遍历一次，只写一次结果
+
+// 现状：自定义数组类型按值相加
+struct eager_vector {
+    std::vector<double> data;
+
+    std::size_t size() const { return data.size(); }
+    double& operator[](std::size_t i) { return data[i]; }
+    double operator[](std::size_t i) const { return data[i]; }
+};
+
+eager_vector operator+(const eager_vector& a, const eager_vector& b) {
+    eager_vector out{std::vector<double>(a.size())};
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        out[i] = a[i] + b[i];
+    }
+    return out;
+}
+
+eager_vector operator-(const eager_vector& a, const eager_vector& b) {
+    eager_vector out{std::vector<double>(a.size())};
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        out[i] = a[i] - b[i];
+    }
+    return out;
+}
+
+template <typename F>
+double best_seconds(F&& f, int repeat) {
+    double best = 1e30;
+    for (int r = 0; r < repeat; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+// 防止结果被优化掉
+void keep(double value) {
+    static volatile double sink;
+    sink = value;
+    (void)sink;
+}
+
+void bench(std::size_t n, int repeat) {
+    eager_vector ea{std::vector<double>(n)}, eb = ea, ec = ea, ed = ea;
+    expr::vector<double> xa(n), xb(n), xc(n), xd(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        ea[i] = xa[i] = static_cast<double>(i % 1000);
+        eb[i] = xb[i] = 0.5 * static_cast<double>(i % 7);
+        ec[i] = xc[i] = 1.0;
+        ed[i] = xd[i] = 2.0;
+    }
+
+    // 融合循环理论上需要的内存流量：读 N 个输入、写 1 个结果
+    const double add_bytes = static_cast<double>(5 * n * sizeof(double));
+    const double sub_bytes = static_cast<double>(4 * n * sizeof(double));
+
+    double loop = best_seconds([&] {
+        std::vector<double> out(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = xa[i] + (xb[i] + (xc[i] + xd[i]));
+        }
+        keep(out[n / 2]);
+    }, repeat);
+    double eager = best_seconds([&] { keep(add(ea, eb, ec, ed)[n / 2]); }, repeat);
+    double fused = best_seconds([&] { keep(add(xa, xb, xc, xd)[n / 2]); }, repeat);
+    std::printf("add(a,b,c,d)    n=%-9zu loop %7.2f GB/s | eager %7.2f GB/s | expr %7.2f GB/s  x%.2f vs eager\n", n,
+                add_bytes / loop / 1e9, add_bytes / eager / 1e9, add_bytes / fused / 1e9, eager / fused);
+
+    eager = best_seconds([&] { keep(sub_fold(ea, eb, ec)[n / 2]); }, repeat);
+    fused = best_seconds([&] { keep(sub_fold(xa, xb, xc)[n / 2]); }, repeat);
+    std::printf("sub_fold(a,b,c) n=%-9zu %20s | eager %7.2f GB/s | expr %7.2f GB/s  x%.2f vs eager\n", n, "",
+                sub_bytes / eager / 1e9, sub_bytes / fused / 1e9, eager / fused);
+}
+
+int main() {
+    const std::size_t sizes[] = {std::size_t(1) << 12, std::size_t(1) << 16, std::size_t(1) << 24};
+    for (std::size_t n : sizes) {
+        bench(n, n < (std::size_t(1) << 20) ? 2000 : 10);
+    }
+    return 0;
+}
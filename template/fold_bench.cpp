@@ -0,0 +1,189 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "add_sub.h"
+
+// add_fold 区间重载的吞吐量测试：手写标量循环 vs 各指令集内核
+
+template <typename F>
+double best_seconds(F&& f, int repeat) {
+    double best = 1e30;
+    for (int r = 0; r < repeat; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+// 防止结果被优化掉
+template <typename T>
+void keep(T value) {
+    static volatile T sink;
+    sink = value;
+    (void)sink;
+}
+
+template <typename T>
+void bench_type(const char* name, std::size_t n, int repeat) {
+    std::vector<T> data(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        data[i] = static_cast<T>(i % 1000);
+    }
+    const double bytes = static_cast<double>(n * sizeof(T));
+
+    double base = best_seconds([&] {
+        T total{};
+        for (std::size_t i = 0; i < n; ++i) {
+            total += data[i];
+        }
+        keep(total);
+    }, repeat);
+    std::printf("%-8s n=%-9zu %-8s %8.2f GB/s\n", name, n, "loop", bytes / base / 1e9);
+
+    const simd::level top = simd::runtime_level();
+    const simd::level levels[] = {simd::level::scalar, simd::level::sse2, simd::level::avx2, simd::level::avx512};
+    for (simd::level lvl : levels) {
+        if (lvl > top) {
+            break;
+        }
+        double t = best_seconds([&] { keep(simd::sum(data.data(), n, lvl)); }, repeat);
+        std::printf("%-8s n=%-9zu %-8s %8.2f GB/s  x%.2f\n", name, n, simd::level_name(lvl), bytes / t / 1e9, base / t);
+    }
+    keep(add_fold(data));
+}
+
+// 各求和策略相对朴素求和的耗时；同时检查可复现模式在各指令集下逐位一致
+template <typename T>
+void bench_modes(const char* name, std::size_t n, int repeat) {
+    std::vector<T> data(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        data[i] = static_cast<T>(1.0 / static_cast<double>(i + 1)) * static_cast<T>(i % 2 ? -1 : 1);
+    }
+    const simd::sum_mode modes[] = {simd::sum_mode::naive, simd::sum_mode::pairwise,
+                                    simd::sum_mode::neumaier, simd::sum_mode::reproducible};
+    const char* mode_names[] = {"naive", "pairwise", "neumaier", "repro"};
+    double naive = 0;
+    for (int m = 0; m < 4; ++m) {
+        T result{};
+        double t = best_seconds([&] { result = simd::sum(data.data(), n, modes[m]); }, repeat);
+        if (m == 0) {
+            naive = t;
+        }
+        std::printf("%-8s n=%-9zu %-8s %8.2f GB/s  x%.2f of naive  sum=%.17g\n", name, n, mode_names[m],
+                    static_cast<double>(n * sizeof(T)) / t / 1e9, t / naive, static_cast<double>(result));
+    }
+
+    const T reference = simd::sum(data.data(), n, simd::sum_mode::reproducible, simd::level::scalar);
+    bool same = true;
+    const simd::level levels[] = {simd::level::sse2, simd::level::avx2, simd::level::avx512};
+    for (simd::level lvl : levels) {
+        if (lvl <= simd::runtime_level()) {
+            same = same && simd::sum(data.data(), n, simd::sum_mode::reproducible, lvl) == reference;
+        }
+    }
+    std::printf("%-8s n=%-9zu reproducible across levels: %s\n", name, n, same ? "yes" : "NO");
+}
+
+// 累加器个数对吞吐的影响：数据放在 L1 里，单累加器受加法延迟限制
+template <typename T, std::size_t... K>
+void bench_unroll(const char* name, std::size_t n, int repeat, std::index_sequence<K...>) {
+    std::vector<T> data(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        data[i] = static_cast<T>(i % 1000);
+    }
+    const double bytes = static_cast<double>(n * sizeof(T));
+    const simd::level top = simd::runtime_level();
+    const simd::level levels[] = {simd::level::scalar, simd::level::sse2, simd::level::avx2, simd::level::avx512};
+    for (simd::level lvl : levels) {
+        if (lvl > top) {
+            break;
+        }
+        const double single = best_seconds([&] { keep(simd::sum_unrolled<1>(data.data(), n, lvl)); }, repeat);
+        std::printf("%-8s n=%-9zu %-8s", name, n, simd::level_name(lvl));
+        ((std::printf("  K=%-2zu %6.2f GB/s", K,
+                      bytes / best_seconds([&] { keep(simd::sum_unrolled<K>(data.data(), n, lvl)); }, repeat) / 1e9)),
+         ...);
+        const double chosen = best_seconds([&] { keep(simd::sum(data.data(), n, lvl)); }, repeat);
+        std::printf("  default x%.2f of K=1\n", single / chosen);
+    }
+    keep(add_fold<unroll<8>>(data));
+}
+
+// checked 策略：逐步 __builtin_add_overflow 的标量循环 vs 各指令集的精确求和内核
+template <typename T>
+void bench_overflow(const char* name, std::size_t n, int repeat) {
+    std::vector<T> data(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        data[i] = static_cast<T>(i * 2654435761u);
+    }
+    const double bytes = static_cast<double>(n * sizeof(T));
+
+    double base = 0;
+#if defined(__GNUC__) || defined(__clang__)
+    base = best_seconds([&] {
+        T total{};
+        bool overflow = false;
+        for (std::size_t i = 0; i < n; ++i) {
+            overflow |= __builtin_add_overflow(total, data[i], &total);
+        }
+        keep(total);
+        keep(overflow);
+    }, repeat);
+    std::printf("%-8s n=%-9zu %-8s %8.2f GB/s\n", name, n, "builtin", bytes / base / 1e9);
+#endif
+
+    const simd::wide_sum reference = simd::exact_sum(data.data(), n, simd::level::scalar);
+    bool same = true;
+    const simd::level top = simd::runtime_level();
+    const simd::level levels[] = {simd::level::scalar, simd::level::sse2, simd::level::avx2, simd::level::avx512};
+    for (simd::level lvl : levels) {
+        if (lvl > top) {
+            break;
+        }
+        simd::wide_sum result;
+        double t = best_seconds([&] { result = simd::exact_sum(data.data(), n, lvl); }, repeat);
+        same = same && result.lo == reference.lo && result.hi == reference.hi;
+        std::printf("%-8s n=%-9zu %-8s %8.2f GB/s", name, n, simd::level_name(lvl), bytes / t / 1e9);
+        if (base > 0) {
+            std::printf("  x%.2f", base / t);
+        }
+        std::printf("\n");
+    }
+    std::printf("%-8s n=%-9zu checked sum identical across levels: %s\n", name, n, same ? "yes" : "NO");
+    keep(add_fold<overflow_mode::checked>(data).overflow);
+}
+
+int main() {
+    std::printf("runtime level: %s\n", simd::level_name(simd::runtime_level()));
+    const std::size_t sizes[] = {std::size_t(1) << 12, std::size_t(1) << 24};
+    for (std::size_t n : sizes) {
+        const int repeat = n < (std::size_t(1) << 20) ? 2000 : 10;
+        bench_type<float>("float", n, repeat);
+        bench_type<double>("double", n, repeat);
+        bench_type<std::int32_t>("int32", n, repeat);
+        bench_type<std::int64_t>("int64", n, repeat);
+    }
+    for (std::size_t n : sizes) {
+        const int repeat = n < (std::size_t(1) << 20) ? 2000 : 10;
+        bench_modes<float>("float", n, repeat);
+        bench_modes<double>("double", n, repeat);
+    }
+    bench_unroll<float>("float", std::size_t(1) << 12, 20000, std::index_sequence<1, 2, 4, 8, 16>{});
+    bench_unroll<double>("double", std::size_t(1) << 12, 20000, std::index_sequence<1, 2, 4, 8, 16>{});
+    for (std::size_t n : sizes) {
+        const int repeat = n < (std::size_t(1) << 20) ? 2000 : 10;
+        bench_overflow<std::int8_t>("int8", n, repeat);
+        bench_overflow<std::int16_t>("int16", n, repeat);
+        bench_overflow<std::int32_t>("int32", n, repeat);
+        bench_overflow<std::uint32_t>("uint32", n, repeat);
+        bench_overflow<std::int64_t>("int64", n, repeat);
+    }
+    return 0;
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "num_format.h"
+
+// 编译期解析的类型安全格式化：safefmt::format<"Value: %, Message: %\n">(42, "Success")。
+// 格式串是类类型的非类型模板参数，构造时就被切成固定的文本块和参数槽，'%' 是一个槽，"%%" 输出 '%'；
+// 槽数与参数个数不一致是编译错误。运行时先按文本块长度和各参数的上限一次性预留空间，
+// 再依次 memcpy 文本块、把参数直接转换进缓冲区，不再逐字符扫描格式串，也没有逐参数的递归。
+//   数值 / 指针         : numfmt（整数查表、浮点数最短往返表示、指针 0x 十六进制）
+//   字符串 / 字符 / bool : 原样拷贝；bool 与 operator<< 一致输出 1 / 0
+//   其余类型           : 经 operator<< 格式化后拷贝（慢路径）
+namespace safefmt {
+
+// 可以作为非类型模板参数的格式串，构造时完成解析
+template <std::size_t N>
+struct pattern {
+    struct chunk {
+        std::size_t offset = 0;
+        std::size_t size = 0;
+    };
+
+    char text[N]{};           // 去掉转义后的文本，各文本块首尾相接
+    chunk chunks[N + 1]{};    // 第 i 个参数之前的文本块；最后一块跟在最后一个参数之后
+    std::size_t slots = 0;    // 参数槽个数
+    std::size_t literal_size = 0;
+
+    constexpr pattern(const char (&format)[N]) {
+        std::size_t begin = 0;
+        for (std::size_t i = 0; i + 1 < N; ++i) {
+            if (format[i] != '%') {
+                text[literal_size++] = format[i];
+            } else if (i + 2 < N && format[i + 1] == '%') {
+                text[literal_size++] = '%';
+                ++i;
+            } else {
+                chunks[slots++] = {begin, literal_size - begin};
+                begin = literal_size;
+            }
+        }
+        chunks[slots] = {begin, literal_size - begin};
+    }
+
+    constexpr std::string_view chunk_view(std::size_t i) const {
+        return std::string_view(text + chunks[i].offset, chunks[i].size);
+    }
+};
+
+// 可增长的字符缓冲区：前 Inline 字节在对象内部，超出后转到堆上，按两倍增长
+template <std::size_t Inline = 256>
+class basic_buffer {
+public:
+    basic_buffer() = default;
+    basic_buffer(const basic_buffer&) = delete;
+    basic_buffer& operator=(const basic_buffer&) = delete;
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    std::size_t capacity() const { return capacity_; }
+    std::string_view view() const { return std::string_view(data_, size_); }
+    std::string str() const { return std::string(data_, size_); }
+    void clear() { size_ = 0; }
+
+    void reserve(std::size_t n) {
+        if (n > capacity_) {
+            grow(n);
+        }
+    }
+
+    void append(const char* p, std::size_t n) {
+        reserve(size_ + n);
+        std::memcpy(data_ + size_, p, n);
+        size_ += n;
+    }
+
+    void append(std::string_view s) { append(s.data(), s.size()); }
+
+    void push_back(char c) {
+        reserve(size_ + 1);
+        data_[size_++] = c;
+    }
+
+    // 保证末尾至少还有 n 字节可写，写完后用 commit 提交实际写到的位置
+    char* prepare(std::size_t n) {
+        reserve(size_ + n);
+        return data_ + size_;
+    }
+
+    void commit(const char* end) { size_ = static_cast<std::size_t>(end - data_); }
+
+private:
+    void grow(std::size_t n) {
+        const std::size_t capacity = std::max(n, capacity_ * 2);
+        std::unique_ptr<char[]> heap(new char[capacity]);
+        std::memcpy(heap.get(), data_, size_);
+        heap_ = std::move(heap);
+        data_ = heap_.get();
+        capacity_ = capacity;
+    }
+
+    char inline_[Inline];
+    std::unique_ptr<char[]> heap_;
+    char* data_ = inline_;
+    std::size_t size_ = 0;
+    std::size_t capacity_ = Inline;
+};
+
+using buffer = basic_buffer<>;
+
+namespace detail {
+
+template <typename T>
+inline constexpr bool is_c_string_v = std::is_same_v<T, const char*> || std::is_same_v<T, char*>;
+
+template <typename T>
+inline constexpr bool is_string_v = std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+
+// 参数转换后最多占用的字节数，用于一次性预留；慢路径的类型不计入，写入时再按需增长
+template <typename T>
+std::size_t size_hint(const T& value) {
+    if constexpr (std::is_same_v<T, bool> || numfmt::is_narrow_character_v<T>) {
+        return 1;
+    } else if constexpr (numfmt::is_number_v<T>) {
+        return numfmt::max_chars<T>;
+    } else if constexpr (is_string_v<T>) {
+        return value.size();
+    } else if constexpr (std::is_array_v<T> && std::is_same_v<std::remove_extent_t<T>, char>) {
+        return std::extent_v<T>;
+    } else if constexpr (std::is_pointer_v<T>) {
+        return is_c_string_v<T> ? 0 : numfmt::max_pointer_chars;
+    } else {
+        return 0;
+    }
+}
+
+template <std::size_t Inline, typename T>
+void put(basic_buffer<Inline>& out, const T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+        out.push_back(value ? '1' : '0');
+    } else if constexpr (numfmt::is_narrow_character_v<T>) {
+        out.push_back(static_cast<char>(value));
+    } else if constexpr (numfmt::is_number_v<T> && !numfmt::is_character_v<T>) {
+        out.commit(numfmt::write(out.prepare(numfmt::max_chars<T>), value));
+    } else if constexpr (is_string_v<T>) {
+        out.append(value.data(), value.size());
+    } else if constexpr (std::is_array_v<T> && std::is_same_v<std::remove_extent_t<T>, char>) {
+        // 字符数组：长度以 N 为界，到第一个 '\0' 为止
+        const char* end = std::char_traits<char>::find(value, std::extent_v<T>, '\0');
+        out.append(value, end ? static_cast<std::size_t>(end - value) : std::extent_v<T>);
+    } else if constexpr (is_c_string_v<T>) {
+        if (value) {
+            out.append(std::string_view(value));
+        } else {
+            out.append("(null)", 6);
+        }
+    } else if constexpr (std::is_pointer_v<T> && !numfmt::is_narrow_character_v<std::remove_cv_t<std::remove_pointer_t<T>>>) {
+        if (value) {
+            out.commit(numfmt::write_pointer(out.prepare(numfmt::max_pointer_chars), value));
+        } else {
+            out.push_back('0');
+        }
+    } else {
+        std::ostringstream os;
+        os << value;
+        out.append(os.view());
+    }
+}
+
+template <auto P, std::size_t Inline, typename... Args, std::size_t... I>
+void format_slots(basic_buffer<Inline>& out, std::index_sequence<I...>, const Args&... args) {
+    out.reserve(out.size() + P.literal_size + (size_hint(args) + ... + 0));
+    ((out.append(P.chunk_view(I)), put(out, args)), ...);
+    out.append(P.chunk_view(sizeof...(Args)));
+}
+
+} // namespace detail
+
+// 追加到已有的缓冲区，适合在循环里复用同一块空间
+template <pattern P, std::size_t Inline, typename... Args>
+void format_to(basic_buffer<Inline>& out, const Args&... args) {
+    static_assert(P.slots == sizeof...(Args), "the number of '%' in the format string must match the arguments");
+    detail::format_slots<P>(out, std::index_sequence_for<Args...>{}, args...);
+}
+
+template <pattern P, typename... Args>
+std::string format(const Args&... args) {
+    buffer out;
+    format_to<P>(out, args...);
+    return out.str();
+}
+
+// 格式化后一次 fwrite 到 stream（默认 stdout）
+template <pattern P, typename... Args>
+void print(std::FILE* stream, const Args&... args) {
+    buffer out;
+    format_to<P>(out, args...);
+    std::fwrite(out.data(), 1, out.size(), stream);
+}
+
+template <pattern P, typename... Args>
+void print(const Args&... args) {
+    print<P>(stdout, args...);
+}
+
+} // namespace safefmt
@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "format.h"
+
+// 格式化吞吐量：同一条 "id=% user=% latency=% us ok=%" 分别用
+//   snprintf、ostringstream、笔记里逐字符扫描并递归的 safePrintf（写进 ostringstream）
+//   和 safefmt::format_to（复用同一块缓冲区）格式化 N 次，输出每次的平均耗时
+
+template <typename F>
+double best_seconds(F&& f, int repeat) {
+    double best = 1e30;
+    for (int r = 0; r < repeat; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+// 防止结果被优化掉
+template <typename T>
+void keep(T value) {
+    static volatile T sink;
+    sink = value;
+    (void)sink;
+}
+
+// C++ 模板元编程.md 5.2 节的写法，输出目标换成参数
+void safePrintf(std::ostream& os, const char* format) {
+    os << format;
+}
+
+template <typename T, typename... Args>
+void safePrintf(std::ostream& os, const char* format, T value, Args... args) {
+    while (*format) {
+        if (*format == '%') {
+            os << value;
+            safePrintf(os, ++format, args...);
+            return;
+        }
+        os << *format++;
+    }
+}
+
+int main(int argc, char** argv) {
+    const std::size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const std::string user = "alice";
+    const double latency = 17.25;
+    std::size_t bytes = 0;
+
+    auto report = [&](const char* name, double seconds) {
+        std::printf("%-14s %8.1f ns/op\n", name, seconds / static_cast<double>(n) * 1e9);
+    };
+
+    report("snprintf", best_seconds([&] {
+        char line[128];
+        for (std::size_t i = 0; i < n; ++i) {
+            bytes += static_cast<std::size_t>(std::snprintf(line, sizeof(line), "id=%zu user=%s latency=%g us ok=%d", i,
+                                                            user.c_str(), latency, 1));
+        }
+    }, 3));
+
+    report("ostringstream", best_seconds([&] {
+        std::ostringstream os;
+        for (std::size_t i = 0; i < n; ++i) {
+            os.str(std::string());
+            os << "id=" << i << " user=" << user << " latency=" << latency << " us ok=" << true;
+            bytes += static_cast<std::size_t>(os.tellp());
+        }
+    }, 3));
+
+    report("safePrintf", best_seconds([&] {
+        std::ostringstream os;
+        for (std::size_t i = 0; i < n; ++i) {
+            os.str(std::string());
+            safePrintf(os, "id=% user=% latency=% us ok=%", i, user, latency, true);
+            bytes += static_cast<std::size_t>(os.tellp());
+        }
+    }, 3));
+
+    report("safefmt", best_seconds([&] {
+        safefmt::buffer out;
+        for (std::size_t i = 0; i < n; ++i) {
+            out.clear();
+            safefmt::format_to<"id=% user=% latency=% us ok=%">(out, i, user, latency, true);
+            bytes += out.size();
+        }
+    }, 3));
+
+    keep(bytes);
+    std::printf("sample: %s\n", safefmt::format<"id=% user=% latency=% us ok=%">(std::size_t(7), user, latency, true).c_str());
+    return 0;
+}
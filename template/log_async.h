@@ -0,0 +1,630 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "log_binary.h"
+#include "log_codec.h"
+#include "log_shm.h"
+#include "log_sink.h"
+#include "log_throttle.h"
+#include "num_format.h"
+
+// 异步日志后端：每个线程一个无锁的单生产者 / 单消费者环形缓冲区，
+// 调用线程只把参数的编码字节拷进去，后台线程逐条解码、格式化并批量写出。
+// 同一线程的记录保持顺序，不同线程之间不保证先后
+namespace logging {
+
+// 缓冲区写满时的处理方式
+//   block     : 调用线程等待后台线程腾出空间
+//   drop      : 丢弃新记录
+//   overwrite : 覆盖最旧的未读记录
+// 后两种丢掉的条数由后台线程汇总成一行 "[logger] N records dropped"
+enum class overflow_policy { block, drop, overwrite };
+
+struct async_options {
+    std::size_t ring_slots = std::size_t(1) << 12; // 每个线程的槽数，向上取 2 的幂；每槽 56 字节
+    overflow_policy overflow = overflow_policy::block;
+    std::chrono::milliseconds poll_interval{1};    // 后台线程空闲时的轮询间隔
+    std::string binary_path;                       // 非空时改写二进制日志到该文件，用 logdecode 还原
+    // 非空时改把二进制日志写进这个名字的 POSIX 共享内存环，由 logcollect 进程格式化并落盘；
+    // 环满时整批丢弃并计数，应用线程和后台线程都不会等待磁盘
+    std::string shm_name;
+    std::size_t shm_bytes = std::size_t(4) << 20;
+};
+
+// 崩溃处理用的输出：写进固定的静态大小缓冲区，写满或 flush 时交给 emit；
+// 不分配内存，也不经过 streambuf 和 locale。put / write 与 std::ostream 同名，渲染模板可以两者共用
+class emergency_writer {
+public:
+    using emit_fn = void (*)(const char*, std::size_t, void*);
+
+    void reset(emit_fn emit, void* context) {
+        emit_ = emit;
+        context_ = context;
+        size_ = 0;
+    }
+
+    emergency_writer& put(char c) {
+        if (size_ == sizeof(data_)) {
+            flush();
+        }
+        data_[size_++] = c;
+        return *this;
+    }
+
+    emergency_writer& write(const char* data, std::streamsize n) {
+        std::size_t left = static_cast<std::size_t>(n);
+        while (left > 0) {
+            if (size_ == sizeof(data_)) {
+                flush();
+            }
+            const std::size_t k = std::min(left, sizeof(data_) - size_);
+            std::memcpy(data_ + size_, data, k);
+            size_ += k;
+            data += k;
+            left -= k;
+        }
+        return *this;
+    }
+
+    emergency_writer& write(std::string_view text) {
+        return write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    void flush() {
+        if (size_ > 0 && emit_) {
+            emit_(data_, size_, context_);
+        }
+        size_ = 0;
+    }
+
+private:
+    char data_[std::size_t(1) << 16];
+    std::size_t size_ = 0;
+    emit_fn emit_ = nullptr;
+    void* context_ = nullptr;
+};
+
+// 把一条记录的参数字节渲染成文本（二进制模式下渲染成紧凑编码）
+using render_fn = void (*)(byte_reader&, std::ostream&);
+// 同一条记录在崩溃处理里的渲染：只用 numfmt、memcpy 写进 emergency_writer
+using emergency_fn = void (*)(byte_reader&, emergency_writer&);
+
+// 每种记录形状一张静态的表，环形缓冲区里只存它的地址
+struct record_format {
+    render_fn render;
+    emergency_fn emergency;
+};
+
+namespace detail {
+
+inline constexpr std::size_t slot_words = 7;
+inline constexpr std::size_t slot_bytes = slot_words * sizeof(std::uint64_t);
+// 每条记录的前两个字：record_format 的地址、(记录序号 << 32 | 字节数)
+inline constexpr std::size_t header_words = 2;
+
+// 一个缓存行一个槽。数据字也用原子变量，生产者覆盖时消费者读到撕裂的数据不算数据竞争，
+// 读完再核对 seq 即可发现
+struct alignas(64) slot {
+    std::atomic<std::uint64_t> seq{0};
+    std::atomic<std::uint64_t> words[slot_words];
+};
+
+// seq = (位置 + 1) << 2 | 是否记录首槽 << 1 | 是否写完；0 表示从未写过
+constexpr std::uint64_t make_seq(std::uint64_t pos, bool start, bool done) {
+    return ((pos + 1) << 2) | (start ? 2u : 0u) | (done ? 1u : 0u);
+}
+
+inline std::size_t round_up_pow2(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n) {
+        p *= 2;
+    }
+    return p;
+}
+
+class ring {
+public:
+    ring(std::size_t slots, overflow_policy policy)
+        : capacity_(round_up_pow2(slots < 2 ? 2 : slots)),
+          mask_(capacity_ - 1),
+          slots_(new slot[capacity_]),
+          policy_(policy),
+          scratch_(capacity_ * slot_words) {}
+
+    static std::size_t slots_for(std::size_t bytes) {
+        const std::size_t words = header_words + (bytes + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+        return (words + slot_words - 1) / slot_words;
+    }
+
+    // 生产者。返回 false 表示没有写入（比整个环还大，或 block 策略下后端已停止），调用方应同步输出
+    bool push(const record_format* format, const unsigned char* data, std::size_t n, const std::atomic<bool>& running) {
+        const std::size_t k = slots_for(n);
+        if (k > capacity_) {
+            return false;
+        }
+        const std::uint64_t pos = head_.load(std::memory_order_relaxed);
+        if (policy_ != overflow_policy::overwrite) {
+            while (pos + k - tail_.load(std::memory_order_acquire) > capacity_) {
+                if (policy_ == overflow_policy::drop) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+                if (!running.load(std::memory_order_relaxed)) {
+                    return false;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        for (std::size_t j = 0; j < k; ++j) {
+            slots_[(pos + j) & mask_].seq.store(make_seq(pos + j, j == 0, false), std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const std::size_t total = header_words + (n + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+        for (std::size_t w = 0; w < total; ++w) {
+            std::uint64_t value = 0;
+            if (w == 0) {
+                value = reinterpret_cast<std::uintptr_t>(format);
+            } else if (w == 1) {
+                value = (static_cast<std::uint64_t>(records_++) << 32) | n;
+            } else {
+                const std::size_t offset = (w - header_words) * sizeof(std::uint64_t);
+                std::memcpy(&value, data + offset, std::min(sizeof(std::uint64_t), n - offset));
+            }
+            slots_[(pos + w / slot_words) & mask_].words[w % slot_words].store(value, std::memory_order_relaxed);
+        }
+
+        // 首槽最后发布：消费者看到首槽写完，就能看到整条记录
+        for (std::size_t j = k; j-- > 0;) {
+            slots_[(pos + j) & mask_].seq.store(make_seq(pos + j, j == 0, true), std::memory_order_release);
+        }
+        head_.store(pos + k, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者：把已写完的记录逐条交给 f(format, reader)，返回处理的条数
+    template <typename F>
+    std::size_t drain(F&& f) {
+        std::size_t count = 0;
+        std::uint64_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            const std::uint64_t s = slots_[pos & mask_].seq.load(std::memory_order_acquire);
+            const std::uint64_t written = s >> 2;
+            if (written < pos + 1 || (written == pos + 1 && !(s & 1))) {
+                break; // 还没写到这里，或者正在写
+            }
+            if (written > pos + 1) {
+                pos = resync(pos); // 整圈被覆盖
+                continue;
+            }
+            if (!(s & 2)) {
+                ++pos; // 前一条记录被覆盖后残留的续槽
+                continue;
+            }
+
+            const std::uint64_t header = slots_[pos & mask_].words[1].load(std::memory_order_relaxed);
+            const std::size_t n = static_cast<std::size_t>(header & 0xFFFFFFFFu);
+            const std::size_t k = slots_for(n);
+            if (k > capacity_ || !copy_record(pos, k)) {
+                pos = resync(pos);
+                continue;
+            }
+
+            const std::uint32_t number = static_cast<std::uint32_t>(header >> 32);
+            lost_ += static_cast<std::uint32_t>(number - expected_);
+            expected_ = number + 1;
+
+            byte_reader reader(reinterpret_cast<const unsigned char*>(scratch_.data() + header_words), n);
+            f(reinterpret_cast<const record_format*>(static_cast<std::uintptr_t>(scratch_[0])), reader);
+            pos += k;
+            ++count;
+            tail_.store(pos, std::memory_order_release);
+        }
+        tail_.store(pos, std::memory_order_release);
+        return count;
+    }
+
+    // 消费者：取走自上次以来丢弃或被覆盖的记录条数
+    std::uint64_t take_lost() {
+        const std::uint64_t n = lost_ + dropped_.exchange(0, std::memory_order_relaxed);
+        lost_ = 0;
+        return n;
+    }
+
+    bool empty() const {
+        return tail_.load(std::memory_order_acquire) >= head_.load(std::memory_order_acquire);
+    }
+
+    // 生产者在检查后端是否运行之前登记、推入之后注销；stop 等各环都注销后再做最后一次排空，
+    // 看到后端仍在运行的生产者推入的记录不会留在环里。标志在生产者自己的缓存行上，不与其他线程争用
+    void begin_push() { pushing_.store(true, std::memory_order_seq_cst); }
+    void end_push() { pushing_.store(false, std::memory_order_release); }
+    bool pushing() const { return pushing_.load(std::memory_order_acquire); }
+
+    // 所属线程已退出；后台线程排空后把它移除
+    std::atomic<bool> closed{false};
+
+private:
+    // 把 k 个槽的数据字复制到 scratch_，复制前后核对每个槽的 seq，期间被覆盖则返回 false
+    bool copy_record(std::uint64_t pos, std::size_t k) {
+        for (std::size_t j = 1; j < k; ++j) {
+            if (slots_[(pos + j) & mask_].seq.load(std::memory_order_acquire) != make_seq(pos + j, false, true)) {
+                return false;
+            }
+        }
+        for (std::size_t j = 0; j < k; ++j) {
+            const slot& sl = slots_[(pos + j) & mask_];
+            for (std::size_t w = 0; w < slot_words; ++w) {
+                scratch_[j * slot_words + w] = sl.words[w].load(std::memory_order_relaxed);
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        for (std::size_t j = 0; j < k; ++j) {
+            if (slots_[(pos + j) & mask_].seq.load(std::memory_order_relaxed) != make_seq(pos + j, j == 0, true)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 跳到仍然有效的最旧位置；丢掉的条数由下一条记录的序号推算
+    std::uint64_t resync(std::uint64_t pos) {
+        const std::uint64_t head = head_.load(std::memory_order_acquire);
+        const std::uint64_t oldest = head > capacity_ ? head - capacity_ : 0;
+        return std::max(pos + 1, oldest);
+    }
+
+    const std::size_t capacity_;
+    const std::size_t mask_;
+    std::unique_ptr<slot[]> slots_;
+    const overflow_policy policy_;
+
+    alignas(64) std::atomic<std::uint64_t> head_{0};
+    std::uint32_t records_ = 0; // 只由生产者访问
+    std::atomic<bool> pushing_{false};
+    alignas(64) std::atomic<std::uint64_t> tail_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::uint32_t expected_ = 0; // 以下只由消费者访问
+    std::uint64_t lost_ = 0;
+    std::vector<std::uint64_t> scratch_;
+};
+
+class async_backend {
+public:
+    static async_backend& instance() {
+        static async_backend backend;
+        return backend;
+    }
+
+    ~async_backend() { stop(); }
+
+    void start(const async_options& options) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (worker_.joinable()) {
+            return;
+        }
+        options_ = options;
+        generation_.fetch_add(1, std::memory_order_release);
+        if (!options_.shm_name.empty()) {
+            shm_ = shm_ring::create(options_.shm_name, options_.shm_bytes);
+            shm_->write(binary_magic, sizeof(binary_magic));
+        } else if (!options_.binary_path.empty()) {
+            binary_.open(options_.binary_path, std::ios::binary | std::ios::trunc);
+            binary_.write(binary_magic, sizeof(binary_magic));
+        }
+        if (shm_ || binary_.is_open()) {
+            sites_written_ = 0;
+            pending_lost_ = 0;
+            emit_binary(std::string(), 0);
+            binary_mode_.store(true, std::memory_order_relaxed);
+        }
+        running_.store(true, std::memory_order_release);
+        worker_ = std::thread([this] { worker_loop(); });
+    }
+
+    // 排空所有线程的缓冲区后停止；之后的日志回到同步输出
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!worker_.joinable()) {
+                return;
+            }
+            running_.store(false, std::memory_order_seq_cst);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        worker_.join();
+        // 等停止前已看到后端在运行的生产者推入完毕；不能持锁等，它们可能正在 local_ring 里登记
+        std::vector<std::shared_ptr<ring>> rings;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            rings = rings_;
+        }
+        for (const std::shared_ptr<ring>& r : rings) {
+            while (r->pushing()) {
+                std::this_thread::yield();
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = false;
+        // 停止前一刻仍在写入的记录
+        drain_all(rings_);
+        binary_mode_.store(false, std::memory_order_relaxed);
+        if (binary_.is_open()) {
+            binary_.close();
+        }
+        if (shm_) {
+            // 共享内存对象留给收集进程读完
+            shm_->close_producer();
+            shm_.reset();
+        }
+    }
+
+    // 等待调用前已提交的记录全部写出
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!worker_.joinable()) {
+            return;
+        }
+        const std::uint64_t target = ++flush_requested_;
+        wake_.notify_one();
+        flushed_.wait(lock, [&] { return flush_done_ >= target || !worker_.joinable(); });
+    }
+
+    bool running() const { return running_.load(std::memory_order_relaxed); }
+
+    bool binary() const { return binary_mode_.load(std::memory_order_relaxed); }
+
+    // 当前线程的缓冲区：首次使用时按当时的配置创建并登记，线程退出时标记为 closed；
+    // 后端以新配置重启后换一个新的
+    ring* local_ring() {
+        struct holder {
+            std::shared_ptr<ring> r;
+            std::uint64_t generation = 0;
+            ~holder() {
+                if (r) {
+                    r->closed.store(true, std::memory_order_release);
+                }
+            }
+        };
+        thread_local holder local;
+        const std::uint64_t generation = generation_.load(std::memory_order_acquire);
+        if (local.generation != generation) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (local.r) {
+                local.r->closed.store(true, std::memory_order_release);
+            }
+            local.r = std::make_shared<ring>(options_.ring_slots, options_.overflow);
+            local.generation = generation;
+            rings_.push_back(local.r);
+        }
+        return local.r.get();
+    }
+
+    const std::atomic<bool>& running_flag() const { return running_; }
+
+    // 以下供崩溃处理使用，不加锁、不等待。
+    // 消费权：后台线程（以及 stop 里最后一次排空）取数并写出一批的全程持有它；
+    // 崩溃处理拿到后不再归还，各个环和共享内存环从此只有它一个消费者 / 生产者
+    bool try_claim_consumer() { return !consuming_.exchange(true, std::memory_order_acquire); }
+
+    shm_ring* emergency_shm() const { return shm_.get(); }
+    const std::string& emergency_binary_path() const { return options_.binary_path; }
+
+    // 调用方已取得消费权：此后的日志改走同步输出，各线程缓冲区里剩下的记录用各自的
+    // emergency 渲染写进 out，每条记录之后 flush，交出去的总是完整的条目。
+    // rings_ 不加锁读取，崩溃时另一个线程恰好在登记新缓冲区的话可能漏掉它
+    void emergency_drain(emergency_writer& out) {
+        running_.store(false, std::memory_order_relaxed);
+        for (;;) {
+            std::size_t drained = 0;
+            for (const std::shared_ptr<ring>& r : rings_) {
+                drained += r->drain([&](const record_format* format, byte_reader& reader) {
+                    format->emergency(reader, out);
+                    out.flush();
+                });
+                if (const std::uint64_t lost = r->take_lost()) {
+                    if (binary()) {
+                        write_dropped(out, lost);
+                    } else {
+                        char number[numfmt::max_chars<std::uint64_t>];
+                        out.write("[logger] ", 9);
+                        out.write(number, numfmt::write(number, lost) - number);
+                        out.write(" records dropped\n", 17);
+                    }
+                    out.flush();
+                }
+            }
+            if (drained == 0) {
+                return;
+            }
+        }
+    }
+
+private:
+    // 输出端先于后端构造，退出时也就后于后端析构，stop 里最后一批仍能写出
+    async_backend() { sink::instance(); }
+
+    void worker_loop() {
+        for (;;) {
+            std::uint64_t target;
+            bool stopping;
+            std::vector<std::shared_ptr<ring>> rings;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait_for(lock, options_.poll_interval,
+                               [&] { return stop_ || flush_requested_ != flush_done_; });
+                target = flush_requested_;
+                stopping = stop_;
+                rings = rings_;
+            }
+            drain_all(rings);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                            [](const std::shared_ptr<ring>& r) {
+                                                return r->closed.load(std::memory_order_acquire) && r->empty();
+                                            }),
+                             rings_.end());
+                flush_done_ = target;
+            }
+            flushed_.notify_all();
+            if (stopping) {
+                return;
+            }
+        }
+    }
+
+    // 把各个环里的记录渲染进 os，返回条数（二进制模式下含丢弃数）
+    std::uint64_t drain_rings(const std::vector<std::shared_ptr<ring>>& rings, std::ostream& os) {
+        std::uint64_t records = 0;
+        for (;;) {
+            std::size_t drained = 0;
+            for (const std::shared_ptr<ring>& r : rings) {
+                drained += r->drain([&](const record_format* format, byte_reader& reader) {
+                    format->render(reader, os);
+                });
+                if (const std::uint64_t lost = r->take_lost()) {
+                    if (binary()) {
+                        write_dropped(os, lost);
+                        records += lost; // 这批整个被丢时，它们也算进丢弃数
+                    } else {
+                        os << "[logger] " << lost << " records dropped\n";
+                    }
+                }
+            }
+            if (drained == 0) {
+                return records;
+            }
+            records += drained;
+        }
+    }
+
+    // 同一时刻只有一个线程在这里（后台线程，或 stop 中 join 之后的调用线程）
+    void drain_all(const std::vector<std::shared_ptr<ring>>& rings) {
+        while (!try_claim_consumer()) {
+            std::this_thread::yield(); // 只有崩溃处理会拿走它，进程马上就要结束
+        }
+        write_batch(drain_rings(rings, text_));
+        consuming_.store(false, std::memory_order_release);
+    }
+
+    void write_batch(std::uint64_t records) {
+        const std::string out = text_.str();
+        if (binary()) {
+            emit_binary(out, records);
+            text_.str(std::string());
+        } else if (!out.empty()) {
+            // 整批交给输出端，是否立即写出由它的刷新策略决定
+            sink::instance().write(out.data(), out.size());
+            text_.str(std::string());
+        }
+    }
+
+    // 本批记录用到的站点都在取数之前登记过，先补写它们的定义。
+    // 共享内存环放不下时丢掉这批，records 条记录计入下一批开头的丢弃数，没写出去的站点定义也留到下一批
+    void emit_binary(const std::string& batch, std::uint64_t records) {
+        const std::size_t sites_before = sites_written_;
+        std::ostringstream head;
+        if (shm_ && pending_lost_) {
+            write_dropped(head, pending_lost_);
+        }
+        for (const site_info& info : site_registry::instance().since(sites_written_)) {
+            write_site(head, static_cast<std::uint32_t>(++sites_written_), info);
+        }
+        std::string out = head.str();
+        out += batch;
+        if (out.empty()) {
+            return;
+        }
+        if (!shm_) {
+            binary_.write(out.data(), static_cast<std::streamsize>(out.size()));
+            binary_.flush();
+        } else if (shm_->write(out.data(), out.size())) {
+            pending_lost_ = 0;
+        } else {
+            sites_written_ = sites_before;
+            pending_lost_ += records;
+        }
+    }
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> binary_mode_{false};
+    std::atomic<bool> consuming_{false};
+    std::atomic<std::uint64_t> generation_{0};
+    async_options options_;
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<ring>> rings_;
+    std::thread worker_;
+    std::condition_variable wake_;
+    std::condition_variable flushed_;
+    std::uint64_t flush_requested_ = 0;
+    std::uint64_t flush_done_ = 0;
+    bool stop_ = false;
+    std::ostringstream text_;
+    std::ofstream binary_;
+    std::unique_ptr<shm_ring> shm_;
+    std::size_t sites_written_ = 0;
+    std::uint64_t pending_lost_ = 0; // 共享内存环满时丢掉的记录，随下一批写出
+};
+
+// 编码到线程局部的暂存区再整体推入环形缓冲区；后端未启动时返回 false
+template <typename Encode>
+bool submit(const record_format* format, std::size_t n, Encode&& encode) {
+    async_backend& backend = async_backend::instance();
+    if (!backend.running()) {
+        return false;
+    }
+    thread_local std::vector<unsigned char> staging;
+    if (staging.size() < n) {
+        staging.resize(n);
+    }
+    byte_writer writer(staging.data());
+    encode(writer);
+    ring* r = backend.local_ring();
+    r->begin_push();
+    // 登记之后再确认一次：stop 要么在这里就被看到，要么会等这次推入结束
+    const bool ok = backend.running_flag().load(std::memory_order_seq_cst) &&
+                    r->push(format, staging.data(), n, backend.running_flag());
+    r->end_push();
+    return ok;
+}
+
+} // namespace detail
+
+inline void start_async(const async_options& options = {}) {
+    detail::async_backend::instance().start(options);
+}
+
+inline void stop_async() {
+    detail::async_backend::instance().stop();
+}
+
+// 等待异步记录全部写出，补上各限流站点的压制汇总，再把输出端的缓冲区写出
+inline void flush() {
+    detail::async_backend::instance().flush();
+    detail::report_suppressed();
+    detail::sink::instance().flush();
+}
+
+inline bool async_enabled() {
+    return detail::async_backend::instance().running();
+}
+
+} // namespace logging
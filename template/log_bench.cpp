@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "log_kv.h"
+#include "logger.h"
+
+// 日志的延迟与吞吐基准：每种输出端 × 每种参数（含 logKV 结构化记录）× 1 到 32 个线程，
+// 先逐次计时得到单次调用的延迟分位数，再整体计时得到总吞吐。
+// 结果写成 JSON（默认 log_bench.json），键的顺序固定，方便在提交之间 diff
+//
+// 用法：LogBench [--json 路径] [--ops 每线程调用数] [--threads 最大线程数]
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// 丢弃一切输出，只保留格式化本身的开销
+class null_buffer : public std::streambuf {
+protected:
+    int_type overflow(int_type ch) override { return traits_type::not_eof(ch); }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+null_buffer null_buf;
+std::ostream null_stream(&null_buf);
+
+const std::filesystem::path scratch = "log_bench.tmp";
+std::ofstream file_stream;
+std::shared_ptr<logging::mapped_file> mapped;
+std::shared_ptr<logging::uring_file> uring;
+
+struct sink_case {
+    const char* name;
+    void (*setup)();
+    void (*teardown)();
+};
+
+void use_sink(std::ostream* target, logging::flush_policy policy) {
+    logging::sink_options options;
+    options.target = target;
+    options.policy = policy;
+    logging::configure_sink(options);
+}
+
+void reset_sink() {
+    logging::flush();
+    logging::configure_sink(logging::sink_options{});
+}
+
+const sink_case sinks[] = {
+    {"sync_null",
+     [] { use_sink(&null_stream, logging::flush_policy::size); },
+     reset_sink},
+    {"sync_file_line",
+     [] {
+         file_stream.open(scratch / "line.log", std::ios::trunc);
+         use_sink(&file_stream, logging::flush_policy::line);
+     },
+     [] {
+         reset_sink();
+         file_stream.close();
+     }},
+    {"sync_file_size",
+     [] {
+         file_stream.open(scratch / "size.log", std::ios::trunc);
+         use_sink(&file_stream, logging::flush_policy::size);
+     },
+     [] {
+         reset_sink();
+         file_stream.close();
+     }},
+    {"mmap",
+     [] {
+         logging::mapped_file_options file_options;
+         file_options.path = (scratch / "mapped.log").string();
+         logging::sink_options options;
+         options.file = mapped = logging::mapped_file::open(file_options);
+         logging::configure_sink(options);
+     },
+     [] {
+         reset_sink();
+         mapped->close();
+         mapped.reset();
+     }},
+    {"uring",
+     [] {
+         logging::uring_file_options file_options;
+         file_options.path = (scratch / "uring.log").string();
+         logging::sink_options options;
+         options.uring = uring = logging::uring_file::open(file_options);
+         logging::configure_sink(options);
+     },
+     [] {
+         reset_sink();
+         uring->close();
+         uring.reset();
+     }},
+    {"async_text",
+     [] {
+         use_sink(&null_stream, logging::flush_policy::size);
+         logging::start_async();
+     },
+     [] {
+         logging::stop_async();
+         reset_sink();
+     }},
+    {"async_binary",
+     [] {
+         logging::async_options options;
+         options.binary_path = (scratch / "bench.tlog").string();
+         logging::start_async(options);
+     },
+     [] {
+         logging::stop_async();
+         reset_sink();
+     }},
+};
+
+struct workload {
+    const char* name;
+    void (*call)(int);
+};
+
+int target_value = 7;
+const std::string owned = "a std::string payload";
+
+const workload workloads[] = {
+    {"int", [](int i) { Logger<int>::log(i); }},
+    {"pointer", [](int) { Logger<int*>::log(&target_value); }},
+    {"string", [](int) { Logger<std::string>::log(owned); }},
+    {"string_view", [](int) { Logger<std::string_view>::log(std::string_view(owned)); }},
+    {"literal", [](int) { logAll("a string literal payload"); }},
+    {"mixed", [](int i) { logAll(i, "literal", owned, 2.5 * i); }},
+    {"fields", [](int i) {
+         using namespace logging::literals;
+         logKV("id"_key, i, "path"_key, "literal", "user"_key, owned, "latency_us"_key, 2.5 * i);
+     }},
+};
+
+struct result {
+    double p50, p99, p999, max;
+    double throughput;
+};
+
+double percentile(std::vector<double>& samples, double q) {
+    const std::size_t k = std::min(samples.size() - 1, static_cast<std::size_t>(q * static_cast<double>(samples.size())));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(k), samples.end());
+    return samples[k];
+}
+
+// 所有线程在同一起跑线出发，返回从出发到最后一个线程结束的秒数
+template <typename F>
+double run_threads(std::size_t threads, F&& body) {
+    std::atomic<std::size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> pool;
+    for (std::size_t t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            body(t);
+        });
+    }
+    while (ready.load() != threads) {
+        std::this_thread::yield();
+    }
+    const auto start = clock_type::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& th : pool) {
+        th.join();
+    }
+    logging::flush();
+    return std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+result measure(const workload& w, std::size_t threads, std::size_t ops) {
+    // 延迟：逐次计时，计时本身的开销见 JSON 里的 timer_overhead_ns
+    std::vector<std::vector<double>> per_thread(threads, std::vector<double>(ops));
+    run_threads(threads, [&](std::size_t t) {
+        std::vector<double>& out = per_thread[t];
+        for (std::size_t i = 0; i < ops; ++i) {
+            const auto begin = clock_type::now();
+            w.call(static_cast<int>(i));
+            out[i] = std::chrono::duration<double, std::nano>(clock_type::now() - begin).count();
+        }
+    });
+    std::vector<double> samples;
+    samples.reserve(threads * ops);
+    for (const std::vector<double>& v : per_thread) {
+        samples.insert(samples.end(), v.begin(), v.end());
+    }
+
+    // 吞吐：不逐次计时，包含把最后一批写出去的时间
+    const double seconds = run_threads(threads, [&](std::size_t) {
+        for (std::size_t i = 0; i < ops; ++i) {
+            w.call(static_cast<int>(i));
+        }
+    });
+
+    result r;
+    r.p50 = percentile(samples, 0.50);
+    r.p99 = percentile(samples, 0.99);
+    r.p999 = percentile(samples, 0.999);
+    r.max = *std::max_element(samples.begin(), samples.end());
+    r.throughput = static_cast<double>(threads * ops) / seconds;
+    return r;
+}
+
+double timer_overhead() {
+    std::vector<double> samples(100000);
+    for (double& s : samples) {
+        const auto begin = clock_type::now();
+        s = std::chrono::duration<double, std::nano>(clock_type::now() - begin).count();
+    }
+    return percentile(samples, 0.50);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string json_path = "log_bench.json";
+    std::size_t ops = 10000;
+    std::size_t max_threads = 32;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            json_path = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--ops") == 0) {
+            ops = std::strtoul(argv[i + 1], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0) {
+            max_threads = std::strtoul(argv[i + 1], nullptr, 10);
+        }
+    }
+    if (ops == 0 || max_threads == 0) {
+        std::fprintf(stderr, "usage: LogBench [--json path] [--ops calls-per-thread] [--threads max]\n");
+        return 2;
+    }
+
+    std::filesystem::create_directories(scratch);
+    const double overhead = timer_overhead();
+    std::FILE* json = std::fopen(json_path.c_str(), "w");
+    if (!json) {
+        std::fprintf(stderr, "cannot write %s\n", json_path.c_str());
+        return 1;
+    }
+    std::fprintf(json, "{\n  \"timer_overhead_ns\": %.1f,\n  \"hardware_threads\": %u,\n  \"ops_per_thread\": %zu,\n",
+                 overhead, std::thread::hardware_concurrency(), ops);
+    std::fprintf(json, "  \"results\": [");
+
+    std::printf("%-15s %-11s %7s %9s %9s %9s %10s %14s\n", "sink", "args", "threads", "p50(ns)", "p99(ns)",
+                "p99.9(ns)", "max(ns)", "calls/s");
+    bool first = true;
+    for (const sink_case& s : sinks) {
+        for (const workload& w : workloads) {
+            for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+                s.setup();
+                const result r = measure(w, threads, ops);
+                s.teardown();
+                std::printf("%-15s %-11s %7zu %9.0f %9.0f %9.0f %10.0f %14.0f\n", s.name, w.name, threads, r.p50, r.p99,
+                            r.p999, r.max, r.throughput);
+                std::fflush(stdout);
+                std::fprintf(json,
+                             "%s\n    {\"sink\": \"%s\", \"args\": \"%s\", \"threads\": %zu, \"p50_ns\": %.1f, "
+                             "\"p99_ns\": %.1f, \"p999_ns\": %.1f, \"max_ns\": %.1f, \"calls_per_s\": %.0f}",
+                             first ? "" : ",", s.name, w.name, threads, r.p50, r.p99, r.p999, r.max, r.throughput);
+                first = false;
+            }
+        }
+    }
+    std::fprintf(json, "\n  ]\n}\n");
+    std::fclose(json);
+    std::filesystem::remove_all(scratch);
+    std::printf("results written to %s\n", json_path.c_str());
+    return 0;
+}
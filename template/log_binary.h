@@ -0,0 +1,212 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "log_codec.h"
+
+// 二进制日志：每个调用点（常量文本 + 参数类型序列）在静态初始化时登记一次，
+// 运行时只记录站点编号和紧凑编码的参数，文本由离线工具 logdecode 还原。
+//
+// 流格式：
+//   头部     "TLOGBIN\x01"
+//   每个条目 varint 编号
+//     编号 0 是控制条目，后跟一个字节的种类：
+//       site_definition  : varint 编号、varint 文本长度、文本、u8 参数个数、每个参数 u8 类型 + varint extent
+//       dropped          : varint 丢弃条数
+//       field_definition : varint 编号、u8 字段个数、每个字段 varint 键长度 + 键 + u8 类型 + varint extent（logKV 的记录）
+//     编号 >= 1 是一条记录，后跟按站点类型序列编码的参数：
+//       bool / char / 8 位整数 : 1 字节
+//       有符号整数             : zigzag + varint
+//       无符号整数、指针       : varint
+//       浮点数                 : 原始字节
+//       C 字符串               : varint(长度 + 1)，空指针记 0，后跟内容
+//       字符数组               : varint(到 '\0' 为止的长度)，后跟内容
+//       std::string / std::string_view / 文本 : varint 长度，后跟内容
+namespace logging {
+
+inline constexpr char binary_magic[8] = {'T', 'L', 'O', 'G', 'B', 'I', 'N', '\x01'};
+
+enum class control_kind : std::uint8_t { site_definition = 1, dropped = 2, field_definition = 3 };
+
+// 可以作为非类型模板参数的字符串字面量
+template <std::size_t N>
+struct fixed_string {
+    char value[N];
+
+    constexpr fixed_string(const char (&text)[N]) {
+        std::copy_n(text, N, value);
+    }
+
+    constexpr std::string_view view() const { return std::string_view(value, N - 1); }
+};
+
+struct site_info {
+    std::string text;
+    std::vector<arg_desc> args;
+    std::vector<std::string> keys; // 非空时为结构化记录，与 args 一一对应
+};
+
+namespace detail {
+
+// 没有 codec 的参数在调用线程格式化成文本
+template <typename T>
+constexpr arg_desc desc_of() {
+    if constexpr (has_codec_v<T>) {
+        return codec<T>::desc();
+    } else {
+        return {arg_type::text, 0};
+    }
+}
+
+class site_registry {
+public:
+    static site_registry& instance() {
+        static site_registry registry;
+        return registry;
+    }
+
+    std::uint32_t add(std::string_view text, std::vector<arg_desc> args, std::vector<std::string> keys = {}) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sites_.push_back(site_info{std::string(text), std::move(args), std::move(keys)});
+        return static_cast<std::uint32_t>(sites_.size()); // 编号从 1 开始
+    }
+
+    // 编号为 first + 1 之后的站点
+    std::vector<site_info> since(std::size_t first) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::vector<site_info>(sites_.begin() + static_cast<std::ptrdiff_t>(std::min(first, sites_.size())),
+                                      sites_.end());
+    }
+
+private:
+    site_registry() = default;
+
+    std::mutex mutex_;
+    std::vector<site_info> sites_;
+};
+
+// 每个 (文本, 类型序列) 组合一个编号，在静态初始化阶段登记
+template <fixed_string Text, typename... Args>
+struct site {
+    static inline const std::uint32_t id =
+        site_registry::instance().add(Text.view(), std::vector<arg_desc>{desc_of<Args>()...});
+};
+
+// 写出函数对输出类型只要求 put(char) 和 write(const char*, n)：后台线程写进 std::ostream，
+// 崩溃处理写进 emergency_writer
+template <typename Out>
+void put_varint(Out& os, std::uint64_t value) {
+    char buffer[10];
+    std::size_t n = 0;
+    while (value >= 0x80) {
+        buffer[n++] = static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    buffer[n++] = static_cast<char>(value);
+    os.write(buffer, static_cast<std::streamsize>(n));
+}
+
+template <typename Out>
+void put_bytes(Out& os, const void* data, std::size_t n) {
+    put_varint(os, n);
+    os.write(static_cast<const char*>(data), static_cast<std::streamsize>(n));
+}
+
+constexpr std::uint64_t zigzag(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+constexpr std::int64_t unzigzag(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+inline void write_site(std::ostream& os, std::uint32_t id, const site_info& info) {
+    put_varint(os, 0);
+    if (!info.keys.empty()) {
+        os.put(static_cast<char>(control_kind::field_definition));
+        put_varint(os, id);
+        os.put(static_cast<char>(info.args.size()));
+        for (std::size_t i = 0; i < info.args.size(); ++i) {
+            put_bytes(os, info.keys[i].data(), info.keys[i].size());
+            os.put(static_cast<char>(info.args[i].type));
+            put_varint(os, info.args[i].extent);
+        }
+        return;
+    }
+    os.put(static_cast<char>(control_kind::site_definition));
+    put_varint(os, id);
+    put_bytes(os, info.text.data(), info.text.size());
+    os.put(static_cast<char>(info.args.size()));
+    for (const arg_desc& d : info.args) {
+        os.put(static_cast<char>(d.type));
+        put_varint(os, d.extent);
+    }
+}
+
+template <typename Out>
+void write_dropped(Out& os, std::uint64_t count) {
+    put_varint(os, 0);
+    os.put(static_cast<char>(control_kind::dropped));
+    put_varint(os, count);
+}
+
+// 把环形缓冲区里的原始编码转成紧凑编码；在后台线程运行
+template <typename T, typename Out>
+void write_binary_arg(byte_reader& r, Out& os) {
+    if constexpr (!has_codec_v<T>) {
+        codec<std::string>::visit(r, [&](std::string_view text) { put_bytes(os, text.data(), text.size()); });
+    } else {
+        codec<T>::visit(r, [&](const auto& value) {
+            using V = std::remove_cv_t<std::remove_reference_t<decltype(value)>>;
+            if constexpr (std::is_array_v<V>) {
+                const std::size_t n = std::find(value, value + std::extent_v<V>, '\0') - value;
+                put_bytes(os, value, n);
+            } else if constexpr (is_c_string_v<V>) {
+                if (!value) {
+                    put_varint(os, 0);
+                } else {
+                    const char* text = reinterpret_cast<const char*>(value);
+                    const std::size_t n = std::strlen(text);
+                    put_varint(os, n + 1);
+                    os.write(text, static_cast<std::streamsize>(n));
+                }
+            } else if constexpr (std::is_same_v<V, std::string_view>) {
+                put_bytes(os, value.data(), value.size());
+            } else if constexpr (std::is_pointer_v<V>) {
+                put_varint(os, reinterpret_cast<std::uintptr_t>(value));
+            } else if constexpr (std::is_floating_point_v<V> || sizeof(V) == 1) {
+                os.write(reinterpret_cast<const char*>(&value), sizeof(V));
+            } else if constexpr (std::is_enum_v<V>) {
+                using U = std::underlying_type_t<V>;
+                if constexpr (std::is_signed_v<U>) {
+                    put_varint(os, zigzag(static_cast<std::int64_t>(value)));
+                } else {
+                    put_varint(os, static_cast<std::uint64_t>(value));
+                }
+            } else if constexpr (std::is_signed_v<V>) {
+                put_varint(os, zigzag(static_cast<std::int64_t>(value)));
+            } else {
+                put_varint(os, static_cast<std::uint64_t>(value));
+            }
+        });
+    }
+}
+
+template <typename Site, typename Out, typename... Args>
+void write_binary(byte_reader& r, Out& os) {
+    put_varint(os, Site::id);
+    (write_binary_arg<Args>(r, os), ...);
+}
+
+} // namespace detail
+
+} // namespace logging
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "num_format.h"
+
+// 日志参数的二进制编码：调用线程只把参数的原始字节写进缓冲区，
+// 格式化推迟到后台线程（或离线工具）里按同样的类型序列解码后再做
+namespace logging {
+
+// 往调用方给定的缓冲区追加字节，调用方负责事先按 codec::size 算好容量
+class byte_writer {
+public:
+    explicit byte_writer(unsigned char* buffer) : cur_(buffer) {}
+
+    void put(const void* data, std::size_t n) {
+        std::memcpy(cur_, data, n);
+        cur_ += n;
+    }
+
+    template <typename T>
+    void put_value(const T& value) {
+        put(&value, sizeof(T));
+    }
+
+private:
+    unsigned char* cur_;
+};
+
+class byte_reader {
+public:
+    byte_reader(const unsigned char* data, std::size_t n) : cur_(data), end_(data + n) {}
+
+    // 缓冲区里的值没有对齐保证，统一 memcpy 出来
+    template <typename T>
+    T get() {
+        T value;
+        std::memcpy(&value, cur_, sizeof(T));
+        cur_ += sizeof(T);
+        return value;
+    }
+
+    const unsigned char* take(std::size_t n) {
+        const unsigned char* p = cur_;
+        cur_ += n;
+        return p;
+    }
+
+    std::size_t remaining() const { return static_cast<std::size_t>(end_ - cur_); }
+
+private:
+    const unsigned char* cur_;
+    const unsigned char* end_;
+};
+
+// 参数的类型标签，二进制日志的站点元数据用它告诉离线解码器每个参数怎么读
+enum class arg_type : std::uint8_t {
+    boolean, character, i8, u8, i16, u16, i32, u32, i64, u64, f32, f64, f80,
+    pointer,    // 普通指针，按地址输出
+    c_string,   // char* / signed char* / unsigned char*（含 const）
+    char_array, // char[N]（字符串字面量），extent 为 N
+    string,     // std::string
+    text,       // 没有 codec 的类型：调用线程已格式化好的文本
+};
+
+struct arg_desc {
+    arg_type type;
+    std::uint32_t extent;
+};
+
+template <typename T>
+constexpr arg_type integer_type() {
+    constexpr bool s = std::is_signed_v<T>;
+    if constexpr (sizeof(T) == 1) return s ? arg_type::i8 : arg_type::u8;
+    else if constexpr (sizeof(T) == 2) return s ? arg_type::i16 : arg_type::u16;
+    else if constexpr (sizeof(T) == 4) return s ? arg_type::i32 : arg_type::u32;
+    else return s ? arg_type::i64 : arg_type::u64;
+}
+
+// codec<T> 约定四个静态函数：
+//   desc()                : 类型标签
+//   size(value)           : 编码后的字节数
+//   encode(writer, value) : 写入字节
+//   visit(reader, f)      : 解码并以可以绑定到 const T& 的值调用 f
+// 没有特化的类型由 logger.h 在调用线程先格式化成文本
+template <typename T, typename = void>
+struct codec {};
+
+template <typename T, typename = void>
+struct has_codec : std::false_type {};
+
+template <typename T>
+struct has_codec<T, std::void_t<decltype(codec<T>::size(std::declval<const T&>()))>> : std::true_type {};
+
+template <typename T>
+inline constexpr bool has_codec_v = has_codec<T>::value;
+
+// 与 operator<< 一致：指向 char / signed char / unsigned char 的指针都按 C 字符串处理，
+// 内容在调用线程拷贝，后台线程不会再去读调用方的内存
+template <typename T>
+inline constexpr bool is_c_string_v =
+    std::is_pointer_v<T> && numfmt::is_narrow_character_v<std::remove_cv_t<std::remove_pointer_t<T>>>;
+
+// 128 位整数没有对应的类型标签，按没有 codec 的类型在调用线程格式化成文本
+template <typename T>
+inline constexpr bool is_wide_integer_v = std::is_integral_v<T> && (sizeof(T) > sizeof(std::uint64_t));
+
+// 算术类型、枚举和普通指针：原样拷贝
+template <typename T>
+struct codec<T, std::enable_if_t<(std::is_arithmetic_v<T> && !is_wide_integer_v<T>) || std::is_enum_v<T> ||
+                                 (std::is_pointer_v<T> && !is_c_string_v<T>)>> {
+    static constexpr arg_desc desc() {
+        if constexpr (std::is_pointer_v<T>) return {arg_type::pointer, 0};
+        else if constexpr (std::is_enum_v<T>) return {integer_type<std::underlying_type_t<T>>(), 0};
+        else if constexpr (std::is_same_v<T, bool>) return {arg_type::boolean, 0};
+        else if constexpr (std::is_same_v<T, char>) return {arg_type::character, 0};
+        else if constexpr (std::is_same_v<T, float>) return {arg_type::f32, 0};
+        else if constexpr (std::is_same_v<T, double>) return {arg_type::f64, 0};
+        else if constexpr (std::is_same_v<T, long double>) return {arg_type::f80, 0};
+        else return {integer_type<T>(), 0};
+    }
+
+    static constexpr std::size_t size(const T&) { return sizeof(T); }
+    static void encode(byte_writer& w, const T& value) { w.put_value(value); }
+
+    template <typename F>
+    static void visit(byte_reader& r, F&& f) {
+        const T value = r.template get<T>();
+        f(value);
+    }
+};
+
+// C 字符串：uint32 长度（空指针记为 null_length）+ 内容 + '\0'，解码后指向缓冲区内部
+template <typename T>
+struct codec<T, std::enable_if_t<is_c_string_v<T>>> {
+    static constexpr std::uint32_t null_length = 0xFFFFFFFFu;
+
+    static constexpr arg_desc desc() { return {arg_type::c_string, 0}; }
+
+    static std::size_t size(const T& value) {
+        return sizeof(std::uint32_t) + (value ? std::strlen(reinterpret_cast<const char*>(value)) + 1 : 0);
+    }
+
+    static void encode(byte_writer& w, const T& value) {
+        if (!value) {
+            w.put_value(null_length);
+            return;
+        }
+        const std::size_t n = std::strlen(reinterpret_cast<const char*>(value));
+        w.put_value(static_cast<std::uint32_t>(n));
+        w.put(value, n + 1);
+    }
+
+    template <typename F>
+    static void visit(byte_reader& r, F&& f) {
+        const std::uint32_t n = r.template get<std::uint32_t>();
+        T value = nullptr;
+        if (n != null_length) {
+            value = reinterpret_cast<T>(const_cast<unsigned char*>(r.take(n + 1)));
+        }
+        f(value);
+    }
+};
+
+// 字符数组（字符串字面量）：整块拷贝，解码时直接把缓冲区当作同类型数组引用
+template <std::size_t N>
+struct codec<char[N]> {
+    static constexpr arg_desc desc() { return {arg_type::char_array, static_cast<std::uint32_t>(N)}; }
+    static constexpr std::size_t size(const char (&)[N]) { return N; }
+    static void encode(byte_writer& w, const char (&value)[N]) { w.put(value, N); }
+
+    template <typename F>
+    static void visit(byte_reader& r, F&& f) {
+        f(*reinterpret_cast<const char(*)[N]>(r.take(N)));
+    }
+};
+
+// std::string / std::string_view：uint32 长度 + 内容，解码为指向缓冲区内部的 string_view，不构造临时字符串
+template <typename T>
+struct codec<T, std::enable_if_t<std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>>> {
+    static constexpr arg_desc desc() { return {arg_type::string, 0}; }
+    static std::size_t size(const T& value) { return sizeof(std::uint32_t) + value.size(); }
+
+    static void encode(byte_writer& w, const T& value) {
+        w.put_value(static_cast<std::uint32_t>(value.size()));
+        w.put(value.data(), value.size());
+    }
+
+    template <typename F>
+    static void visit(byte_reader& r, F&& f) {
+        const std::uint32_t n = r.template get<std::uint32_t>();
+        const std::string_view value(reinterpret_cast<const char*>(r.take(n)), n);
+        f(value);
+    }
+};
+
+} // namespace logging
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string_view>
+
+#include "log_async.h"
+#include "log_sink.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#define LOGGING_HAS_CRASH_HANDLER 1
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define LOGGING_HAS_BACKTRACE 1
+#else
+#define LOGGING_HAS_BACKTRACE 0
+#endif
+#else
+#define LOGGING_HAS_CRASH_HANDLER 0
+#endif
+
+// 崩溃时的紧急刷新：SIGSEGV / SIGBUS / SIGILL / SIGFPE / SIGABRT 到来时，
+// 把输出端缓冲区里还没写出的内容和各线程异步缓冲区里剩下的记录写出去，再附上调用栈，
+// 然后恢复原来的处理方式重新发出信号。
+//
+// 处理函数里不加锁、不用 stdio，所有输出都是 write(2)（或写进映射区 / 共享内存环）：
+//   - 输出端缓冲区直接 write 到 fd；
+//   - 异步记录用各自的 emergency 渲染函数（numfmt 和 memcpy，不经过 ostream、locale 和堆）
+//     格式化进一块静态缓冲区，每条写完就交出去：
+//       文本模式写到 fd（配置了映射文件时写进当前分段，配置了 io_uring 文件时 pwrite 到文件末尾），
+//       二进制文件模式以 O_APPEND 重新打开该文件追加，共享内存模式直接写进环；
+//   - 映射文件里已经写进去的内容在页缓存里，进程死掉也不会丢，不需要处理；
+//     io_uring 文件里还没封口的缓冲区先 pwrite 出去，已提交的写入由内核完成。
+// 没有 codec 的参数在调用线程就已格式化成文本，这里原样拷贝；枚举、宽字符等需要 operator<< 的
+// 参数只写占位文本。
+// 限制：崩溃的正是后台线程，或它在等一把被崩溃线程持有的锁时，等待超时后跳过异步缓冲区；
+// 备用信号栈只为调用 install_crash_handler 的线程设置
+namespace logging {
+
+struct crash_options {
+    int fd = -1;                       // 崩溃报告写到哪里；-1 时按输出端目标推断：std::cout 为 1，其余为 2
+    bool backtrace = true;
+    std::chrono::milliseconds wait{200}; // 等后台线程写完手头这一批的最长时间
+};
+
+#if LOGGING_HAS_CRASH_HANDLER
+
+namespace detail {
+
+inline void write_all(int fd, const char* data, std::size_t n) {
+    while (n > 0) {
+        const ssize_t k = ::write(fd, data, n);
+        if (k < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += k;
+        n -= static_cast<std::size_t>(k);
+    }
+}
+
+inline void write_all(int fd, std::string_view text) {
+    write_all(fd, text.data(), text.size());
+}
+
+class crash_handler {
+public:
+    static crash_handler& instance() {
+        static crash_handler handler;
+        return handler;
+    }
+
+    void install(const crash_options& options) {
+        options_ = options;
+#if LOGGING_HAS_BACKTRACE
+        // 第一次调用会加载 libgcc，先在这里做掉，信号处理函数里就不再分配内存
+        void* frame;
+        ::backtrace(&frame, 1);
+#endif
+        // 栈溢出引起的 SIGSEGV 需要在另一块栈上处理
+        stack_t stack{};
+        stack.ss_sp = alt_stack_;
+        stack.ss_size = sizeof(alt_stack_);
+        ::sigaltstack(&stack, nullptr);
+
+        struct sigaction action {};
+        action.sa_handler = &on_signal;
+        ::sigemptyset(&action.sa_mask);
+        for (const int sig : signals) {
+            ::sigaddset(&action.sa_mask, sig);
+        }
+        action.sa_flags = SA_ONSTACK;
+        for (std::size_t i = 0; i < signal_count; ++i) {
+            ::sigaction(signals[i], &action, installed_ ? nullptr : &previous_[i]);
+        }
+        installed_ = true;
+    }
+
+private:
+    static constexpr int signals[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+    static constexpr std::size_t signal_count = sizeof(signals) / sizeof(signals[0]);
+
+    crash_handler() = default;
+
+    static void on_signal(int sig) { instance().handle(sig); }
+
+    void handle(int sig) {
+        const int saved_errno = errno;
+        if (handling_.exchange(true)) {
+            // 另一个线程也崩溃了：等第一个线程写完后结束进程
+            for (;;) {
+                ::pause();
+            }
+        }
+        dump(sig);
+        for (std::size_t i = 0; i < signal_count; ++i) {
+            if (signals[i] == sig) {
+                ::sigaction(sig, &previous_[i], nullptr);
+            }
+        }
+        // 处理期间该信号被屏蔽，返回后才递送给原来的处理方式（默认是终止并生成 core）
+        ::raise(sig);
+        errno = saved_errno;
+    }
+
+    void dump(int sig) {
+        sink& out = sink::instance();
+        fd_ = options_.fd >= 0 ? options_.fd : out.emergency_target() == &std::cout ? STDOUT_FILENO : STDERR_FILENO;
+
+        // 按时间顺序：输出端缓冲区、异步缓冲区，最后是崩溃报告
+        if (!out.emergency_file()) {
+            write_all(fd_, out.emergency_pending());
+        }
+        drain_async();
+
+        char number[16];
+        write_all(fd_, "[logger] fatal signal ");
+        write_all(fd_, signal_name(sig));
+        write_all(fd_, " (");
+        write_all(fd_, format_decimal(number, static_cast<unsigned>(sig)));
+        write_all(fd_, ")\n");
+
+#if LOGGING_HAS_BACKTRACE
+        if (options_.backtrace) {
+            void* frames[64];
+            const int n = ::backtrace(frames, 64);
+            write_all(fd_, "[logger] backtrace:\n");
+            ::backtrace_symbols_fd(frames, n, fd_);
+        }
+#endif
+    }
+
+    void drain_async() {
+        async_backend& backend = async_backend::instance();
+        bool claimed = backend.try_claim_consumer();
+        const timespec pause{0, 1000000};
+        for (auto waited = std::chrono::milliseconds(0); !claimed && waited < options_.wait;
+             waited += std::chrono::milliseconds(1)) {
+            ::nanosleep(&pause, nullptr);
+            claimed = backend.try_claim_consumer();
+        }
+        // 后台线程停下之后 io_uring 文件的偏移才不再变化，这时再写出它还没落盘的缓冲区
+        if (uring_file* uring = sink::instance().emergency_uring()) {
+            uring->emergency_flush();
+        }
+        if (!claimed) {
+            write_all(fd_, "[logger] async backend busy, buffered records not written\n");
+            return;
+        }
+
+        int binary_fd = -1;
+        if (shm_ring* shm = backend.emergency_shm()) {
+            buffer_.reset(&emit_shm, shm);
+        } else if (backend.binary()) {
+            binary_fd = ::open(backend.emergency_binary_path().c_str(), O_WRONLY | O_APPEND);
+            if (binary_fd < 0) {
+                write_all(fd_, "[logger] cannot reopen binary log, buffered records not written\n");
+                return;
+            }
+            buffer_.reset(&emit_fd, &binary_fd);
+        } else if (mapped_file* file = sink::instance().emergency_file()) {
+            buffer_.reset(&emit_file, file);
+        } else if (uring_file* uring = sink::instance().emergency_uring()) {
+            buffer_.reset(&emit_uring, uring);
+        } else {
+            buffer_.reset(&emit_fd, &fd_);
+        }
+        backend.emergency_drain(buffer_);
+        if (binary_fd >= 0) {
+            ::close(binary_fd);
+        }
+    }
+
+    static void emit_fd(const char* data, std::size_t n, void* context) {
+        write_all(*static_cast<int*>(context), data, n);
+    }
+
+    static void emit_file(const char* data, std::size_t n, void* context) {
+        static_cast<mapped_file*>(context)->emergency_write(data, n);
+    }
+
+    static void emit_uring(const char* data, std::size_t n, void* context) {
+        static_cast<uring_file*>(context)->emergency_write(data, n);
+    }
+
+    static void emit_shm(const char* data, std::size_t n, void* context) {
+        static_cast<shm_ring*>(context)->write(data, n);
+    }
+
+    static std::string_view signal_name(int sig) {
+        switch (sig) {
+        case SIGSEGV: return "SIGSEGV";
+        case SIGBUS: return "SIGBUS";
+        case SIGILL: return "SIGILL";
+        case SIGFPE: return "SIGFPE";
+        case SIGABRT: return "SIGABRT";
+        default: return "signal";
+        }
+    }
+
+    static std::string_view format_decimal(char (&buffer)[16], unsigned value) {
+        char* end = buffer + sizeof(buffer);
+        char* p = end;
+        do {
+            *--p = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        return std::string_view(p, static_cast<std::size_t>(end - p));
+    }
+
+    crash_options options_;
+    bool installed_ = false;
+    struct sigaction previous_[signal_count];
+    std::atomic<bool> handling_{false};
+    int fd_ = STDERR_FILENO;
+    emergency_writer buffer_;
+    alignas(16) char alt_stack_[std::size_t(1) << 16];
+};
+
+} // namespace detail
+
+// 安装崩溃处理；可以重复调用以更换选项，原来的处理方式只在第一次安装时保存
+inline void install_crash_handler(const crash_options& options = {}) {
+    detail::crash_handler::instance().install(options);
+}
+
+#else
+
+// 没有 POSIX 信号的平台上什么也不做
+inline void install_crash_handler(const crash_options& = {}) {}
+
+#endif
+
+} // namespace logging
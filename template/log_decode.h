@@ -0,0 +1,246 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "log_kv.h"
+
+// 二进制日志流（格式见 log_binary.h）的解码器，由 logdecode 和 logcollect 共用。
+// 可以分块喂入：不完整的尾部条目留到下一块再解，输出与文本模式逐行一致；
+// logKV 的记录按构造时给定的 kv_format 渲染
+namespace logging {
+
+class truncated_stream : public std::runtime_error {
+public:
+    truncated_stream() : std::runtime_error("truncated stream") {}
+};
+
+namespace detail {
+
+class stream_reader {
+public:
+    stream_reader(const unsigned char* data, std::size_t n) : begin_(data), cur_(data), end_(data + n) {}
+
+    bool done() const { return cur_ == end_; }
+    std::size_t consumed() const { return static_cast<std::size_t>(cur_ - begin_); }
+
+    const unsigned char* take(std::size_t n) {
+        if (static_cast<std::size_t>(end_ - cur_) < n) {
+            throw truncated_stream();
+        }
+        const unsigned char* p = cur_;
+        cur_ += n;
+        return p;
+    }
+
+    std::uint8_t byte() { return *take(1); }
+
+    template <typename T>
+    T raw() {
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::uint64_t varint() {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            const std::uint8_t b = byte();
+            value |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) {
+                return value;
+            }
+        }
+        throw std::runtime_error("malformed varint");
+    }
+
+    std::int64_t svarint() { return unzigzag(varint()); }
+
+    std::string_view bytes(std::size_t n) { return std::string_view(reinterpret_cast<const char*>(take(n)), n); }
+
+private:
+    const unsigned char* begin_;
+    const unsigned char* cur_;
+    const unsigned char* end_;
+};
+
+} // namespace detail
+
+class stream_decoder {
+public:
+    explicit stream_decoder(kv_format fields = kv_format::text) : fields_(fields) {}
+
+    // 解出 data 里所有完整的条目写到 os；格式错误时抛 std::runtime_error
+    void feed(const unsigned char* data, std::size_t n, std::ostream& os) {
+        pending_.insert(pending_.end(), data, data + n);
+        detail::stream_reader in(pending_.data(), pending_.size());
+        std::size_t done = 0;
+        try {
+            if (!header_seen_) {
+                if (in.bytes(sizeof(binary_magic)) != std::string_view(binary_magic, sizeof(binary_magic))) {
+                    throw std::runtime_error("not a binary log");
+                }
+                header_seen_ = true;
+                done = in.consumed();
+            }
+            while (!in.done()) {
+                entry_.str(std::string());
+                decode_entry(in, entry_);
+                done = in.consumed();
+                const std::string_view text = entry_.view();
+                os.write(text.data(), static_cast<std::streamsize>(text.size()));
+            }
+        } catch (const truncated_stream&) {
+            // 条目的剩余部分还没到
+        }
+        pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(done));
+    }
+
+    // 没有解到一半的条目
+    bool idle() const { return pending_.empty(); }
+
+private:
+    void decode_entry(detail::stream_reader& in, std::ostream& os) {
+        const std::uint64_t id = in.varint();
+        if (id != 0) {
+            const auto it = sites_.find(id);
+            if (it == sites_.end()) {
+                throw std::runtime_error("record for undefined site " + std::to_string(id));
+            }
+            if (!it->second.keys.empty()) {
+                decode_fields(in, it->second, os);
+                return;
+            }
+            if (!it->second.text.empty()) {
+                detail::format_literal(os, it->second.text);
+                os << '\n';
+            }
+            for (const arg_desc& d : it->second.args) {
+                decode_arg(in, d, os);
+            }
+            return;
+        }
+        switch (static_cast<control_kind>(in.byte())) {
+        case control_kind::site_definition: {
+            const std::uint64_t site_id = in.varint();
+            site_info info;
+            info.text = std::string(in.bytes(in.varint()));
+            for (std::size_t argc = in.byte(); argc > 0; --argc) {
+                const arg_type type = static_cast<arg_type>(in.byte());
+                info.args.push_back(arg_desc{type, static_cast<std::uint32_t>(in.varint())});
+            }
+            sites_[site_id] = std::move(info);
+            break;
+        }
+        case control_kind::field_definition: {
+            const std::uint64_t site_id = in.varint();
+            site_info info;
+            for (std::size_t argc = in.byte(); argc > 0; --argc) {
+                info.keys.emplace_back(in.bytes(in.varint()));
+                const arg_type type = static_cast<arg_type>(in.byte());
+                info.args.push_back(arg_desc{type, static_cast<std::uint32_t>(in.varint())});
+            }
+            if (info.keys.empty()) {
+                throw std::runtime_error("field definition without fields");
+            }
+            sites_[site_id] = std::move(info);
+            break;
+        }
+        case control_kind::dropped: os << "[logger] " << in.varint() << " records dropped\n"; break;
+        default: throw std::runtime_error("unknown control entry");
+        }
+    }
+
+    struct preformatted {
+        std::string_view text;
+    };
+
+    struct literal {
+        std::string_view text;
+    };
+
+    // 按类型标签解出一个值，以 Logger 特化对应的类型调用 f；
+    // 字符数组以 literal、调用线程已格式化好的文本以 preformatted 给出
+    template <typename F>
+    static void visit_arg(detail::stream_reader& in, const arg_desc& d, F&& f) {
+        switch (d.type) {
+        case arg_type::boolean: f(in.raw<bool>()); break;
+        case arg_type::character: f(in.raw<char>()); break;
+        case arg_type::i8: f(in.raw<signed char>()); break;
+        case arg_type::u8: f(in.raw<unsigned char>()); break;
+        case arg_type::i16: f(static_cast<short>(in.svarint())); break;
+        case arg_type::u16: f(static_cast<unsigned short>(in.varint())); break;
+        case arg_type::i32: f(static_cast<int>(in.svarint())); break;
+        case arg_type::u32: f(static_cast<unsigned>(in.varint())); break;
+        case arg_type::i64: f(static_cast<std::int64_t>(in.svarint())); break;
+        case arg_type::u64: f(static_cast<std::uint64_t>(in.varint())); break;
+        case arg_type::f32: f(in.raw<float>()); break;
+        case arg_type::f64: f(in.raw<double>()); break;
+        case arg_type::f80: f(in.raw<long double>()); break;
+        case arg_type::pointer: f(reinterpret_cast<const void*>(static_cast<std::uintptr_t>(in.varint()))); break;
+        case arg_type::c_string: {
+            // signed char* / unsigned char* 也按这个标签记录，Logger 对它们的输出与 const char* 相同
+            const std::uint64_t n = in.varint();
+            if (n == 0) {
+                f(static_cast<const char*>(nullptr));
+            } else {
+                const std::string text(in.bytes(n - 1));
+                f(text.c_str());
+            }
+            break;
+        }
+        case arg_type::char_array: f(literal{in.bytes(in.varint())}); break;
+        case arg_type::string: f(in.bytes(in.varint())); break;
+        case arg_type::text: f(preformatted{in.bytes(in.varint())}); break;
+        default: throw std::runtime_error("unknown argument type");
+        }
+    }
+
+    static void decode_arg(detail::stream_reader& in, const arg_desc& d, std::ostream& os) {
+        visit_arg(in, d, [&](const auto& value) {
+            using V = std::remove_cv_t<std::remove_reference_t<decltype(value)>>;
+            if constexpr (std::is_same_v<V, preformatted>) {
+                os << value.text;
+            } else if constexpr (std::is_same_v<V, literal>) {
+                detail::format_literal(os, value.text);
+            } else {
+                Logger<V>::format(os, value);
+            }
+        });
+        os << '\n';
+    }
+
+    void decode_fields(detail::stream_reader& in, const site_info& info, std::ostream& os) const {
+        detail::begin_fields(os, fields_);
+        for (std::size_t i = 0; i < info.args.size(); ++i) {
+            detail::put_key(os, info.keys[i], i == 0, fields_);
+            visit_arg(in, info.args[i], [&](const auto& value) {
+                using V = std::remove_cv_t<std::remove_reference_t<decltype(value)>>;
+                if constexpr (std::is_same_v<V, preformatted> || std::is_same_v<V, literal>) {
+                    detail::put_string(os, value.text, fields_);
+                } else {
+                    detail::put_field_value(os, value, fields_);
+                }
+            });
+        }
+        detail::end_fields(os, fields_);
+        os << '\n';
+    }
+
+    std::vector<unsigned char> pending_;
+    bool header_seen_ = false;
+    std::unordered_map<std::uint64_t, site_info> sites_;
+    std::ostringstream entry_;
+    kv_format fields_;
+};
+
+} // namespace logging
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "log_sink.h"
+#include "num_format.h"
+
+// logAll 的聚集写出：同步模式、line 策略、目标有文件描述符时，整条记录用一次 writev 写出。
+// 字符串类参数（std::string、std::string_view、C 字符串、字符数组）按原地址引用，不再拷进流缓冲区；
+// 数值和指针连同前缀、换行格式化进栈上的小块暂存区。输出与逐个参数调用 Logger<T>::format 完全相同，
+// 且整条记录一次进入内核，不会和其他线程的行交错。
+// 参数里有其他类型（有自定义 operator<< 或 Logger 特化的类型）时整条记录照旧走输出端缓冲区
+namespace logging::detail {
+
+template <typename T>
+inline constexpr bool is_gather_string_v =
+    std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> ||
+    (std::is_array_v<T> && std::is_same_v<std::remove_extent_t<T>, char>);
+
+template <typename T>
+inline constexpr bool is_gather_c_string_v =
+    std::is_pointer_v<T> && numfmt::is_narrow_character_v<std::remove_cv_t<std::remove_pointer_t<T>>>;
+
+template <typename T>
+inline constexpr bool gatherable_v = std::is_same_v<T, bool> || numfmt::is_narrow_character_v<T> ||
+                                     (numfmt::is_number_v<T> && !numfmt::is_character_v<T>) ||
+                                     std::is_pointer_v<T> || is_gather_string_v<T>;
+
+#if LOGGING_HAS_WRITEV
+
+// 字符串参数占三段：前缀、原地的内容、换行；数值和指针连同前缀、换行写进暂存区，占一段
+struct gather_slot {
+    char scratch[16 + (numfmt::max_chars<long double> > numfmt::max_pointer_chars ? numfmt::max_chars<long double>
+                                                                                   : numfmt::max_pointer_chars)];
+};
+
+inline iovec gather_segment(const char* data, std::size_t n) {
+    return iovec{const_cast<char*>(data), n};
+}
+
+inline iovec* gather_text(iovec* iov, std::string_view prefix, const char* data, std::size_t n) {
+    *iov++ = gather_segment(prefix.data(), prefix.size());
+    *iov++ = gather_segment(data, n);
+    *iov++ = gather_segment("\n", 1);
+    return iov;
+}
+
+// 与对应 Logger<T>::format 的输出逐字节一致
+template <typename T>
+iovec* gather_one(iovec* iov, gather_slot& slot, const T& value) {
+    if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>) {
+        return gather_text(iov, "StringLog: ", value.data(), value.size());
+    } else if constexpr (std::is_array_v<T>) {
+        const char* end = std::char_traits<char>::find(value, std::extent_v<T>, '\0');
+        return gather_text(iov, "Log: ", value, end ? static_cast<std::size_t>(end - value) : std::extent_v<T>);
+    } else if constexpr (is_gather_c_string_v<T>) {
+        if (!value) {
+            return gather_text(iov, "Log: ", "nullptr", 7);
+        }
+        const char* text = reinterpret_cast<const char*>(value);
+        return gather_text(iov, "Log*: ", text, std::char_traits<char>::length(text));
+    } else {
+        char* p = slot.scratch;
+        if constexpr (std::is_pointer_v<T>) {
+            if (value) {
+                p = numfmt::write_pointer(std::char_traits<char>::copy(p, "Log*: ", 6) + 6, value);
+            } else {
+                p = std::char_traits<char>::copy(p, "Log: nullptr", 12) + 12;
+            }
+        } else {
+            p = std::char_traits<char>::copy(p, "Log: ", 5) + 5;
+            if constexpr (std::is_same_v<T, bool>) {
+                *p++ = value ? '1' : '0';
+            } else if constexpr (numfmt::is_narrow_character_v<T>) {
+                *p++ = static_cast<char>(value);
+            } else {
+                p = numfmt::write(p, value);
+            }
+        }
+        *p++ = '\n';
+        *iov++ = gather_segment(slot.scratch, static_cast<std::size_t>(p - slot.scratch));
+        return iov;
+    }
+}
+
+template <typename... Args, std::size_t... I>
+bool gather_record(std::index_sequence<I...>, const Args&... args) {
+    gather_slot slots[sizeof...(Args)];
+    iovec iov[3 * sizeof...(Args)];
+    iovec* end = iov;
+    ((end = gather_one(end, slots[I], args)), ...);
+    return sink::instance().gather(iov, static_cast<std::size_t>(end - iov));
+}
+
+#endif
+
+// 能聚集写出时写出整条记录并返回 true；返回 false 时调用方逐个参数走输出端缓冲区
+template <typename... Args>
+bool gather(const Args&... args) {
+#if LOGGING_HAS_WRITEV
+    if constexpr (sizeof...(Args) > 0 && (gatherable_v<Args> && ...)) {
+        if (sink::instance().gather_fd() >= 0) {
+            return gather_record(std::index_sequence_for<Args...>{}, args...);
+        }
+    }
+#endif
+    ((void)args, ...);
+    return false;
+}
+
+} // namespace logging::detail
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "logger.h"
+
+// 结构化日志：logKV("user"_key, id, "latency_us"_key, t)。
+// 键是编译期字符串，值沿用参数的类型化编码（没有 codec 的类型照旧由 Logger<T>::format 先转成文本），
+// 一条记录渲染成一行：
+//   text : user=42 latency_us=17.5
+//   json : {"user":42,"latency_us":17.5}
+// 渲染格式由 set_kv_format 选择；二进制模式下键只随站点定义写一次，由 logdecode [--json] 渲染
+namespace logging {
+
+enum class kv_format : std::uint8_t { text, json };
+
+namespace detail {
+
+inline std::atomic<kv_format> runtime_kv_format{kv_format::text};
+
+// 键只允许字母、数字和 "_.-"，两种格式下都不需要转义
+constexpr bool valid_key(std::string_view name) {
+    if (name.empty()) {
+        return false;
+    }
+    for (const char c : name) {
+        const bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' ||
+                        c == '.' || c == '-';
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace detail
+
+inline void set_kv_format(kv_format f) {
+    detail::runtime_kv_format.store(f, std::memory_order_relaxed);
+}
+
+inline kv_format current_kv_format() {
+    return detail::runtime_kv_format.load(std::memory_order_relaxed);
+}
+
+template <fixed_string Name>
+struct key {
+    static_assert(detail::valid_key(Name.view()), "keys are non-empty and use only letters, digits, '_', '.', '-'");
+    static constexpr std::string_view name = Name.view();
+};
+
+inline namespace literals {
+
+template <fixed_string Name>
+constexpr key<Name> operator""_key() {
+    return {};
+}
+
+} // namespace literals
+
+namespace detail {
+
+template <typename T>
+struct is_key : std::false_type {};
+
+template <fixed_string Name>
+struct is_key<key<Name>> : std::true_type {};
+
+// 加引号并转义 '"'、'\\' 和控制字符，其余字节（包括 UTF-8）原样写出
+// 输出类型可以是 std::ostream，也可以是崩溃处理用的 emergency_writer
+template <typename Out>
+void put_quoted(Out& os, std::string_view s) {
+    static constexpr char hex[] = "0123456789abcdef";
+    os.put('"');
+    std::size_t run = 0;
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        os.write(s.data() + run, static_cast<std::streamsize>(i - run));
+        run = i + 1;
+        switch (c) {
+        case '"': os.write("\\\"", 2); break;
+        case '\\': os.write("\\\\", 2); break;
+        case '\n': os.write("\\n", 2); break;
+        case '\r': os.write("\\r", 2); break;
+        case '\t': os.write("\\t", 2); break;
+        default: {
+            const char escape[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+            os.write(escape, sizeof(escape));
+        }
+        }
+    }
+    os.write(s.data() + run, static_cast<std::streamsize>(s.size() - run));
+    os.put('"');
+}
+
+// 文本格式只在值为空或含空白、'='、'"'、控制字符时加引号
+template <typename Out>
+void put_string(Out& os, std::string_view s, kv_format f) {
+    if (f == kv_format::text && !s.empty() && std::none_of(s.begin(), s.end(), [](char c) {
+            return static_cast<unsigned char>(c) <= ' ' || c == '=' || c == '"' || c == '\\' || c == 0x7F;
+        })) {
+        os.write(s.data(), static_cast<std::streamsize>(s.size()));
+        return;
+    }
+    put_quoted(os, s);
+}
+
+// 整数与浮点数交给 numfmt，浮点数取能精确还原的最短表示
+template <typename Out, typename T>
+void put_number(Out& os, T value) {
+    char buffer[numfmt::max_chars<T>];
+    os.write(buffer, numfmt::write(buffer, value) - buffer);
+}
+
+// 一个已解码的值；bool 为 true/false，字符为单字符字符串，8 位整数按数值输出，
+// JSON 下非有限浮点数和空指针为 null，指针为 "0x..." 字符串
+template <typename Out, typename V>
+void put_field_value(Out& os, const V& value, kv_format f) {
+    if constexpr (std::is_same_v<V, bool>) {
+        value ? os.write("true", 4) : os.write("false", 5);
+    } else if constexpr (std::is_same_v<V, char>) {
+        put_string(os, std::string_view(&value, 1), f);
+    } else if constexpr (std::is_enum_v<V>) {
+        put_number(os, static_cast<std::underlying_type_t<V>>(value));
+    } else if constexpr (std::is_integral_v<V>) {
+        put_number(os, value);
+    } else if constexpr (std::is_floating_point_v<V>) {
+        if (f == kv_format::json && !std::isfinite(value)) {
+            os.write("null", 4);
+        } else {
+            put_number(os, value);
+        }
+    } else if constexpr (std::is_array_v<V>) {
+        put_string(os, std::string_view(value, literal_length(value)), f);
+    } else if constexpr (is_c_string_v<V>) {
+        if (value) {
+            put_string(os, reinterpret_cast<const char*>(value), f);
+        } else {
+            os.write("null", 4);
+        }
+    } else if constexpr (std::is_pointer_v<V>) {
+        if (!value) {
+            os.write("null", 4);
+            return;
+        }
+        char buffer[numfmt::max_pointer_chars + 2];
+        char* p = buffer;
+        if (f == kv_format::json) {
+            *p++ = '"';
+        }
+        p = numfmt::write_pointer(p, value);
+        if (f == kv_format::json) {
+            *p++ = '"';
+        }
+        os.write(buffer, p - buffer);
+    } else {
+        put_string(os, std::string_view(value), f);
+    }
+}
+
+template <typename Out>
+void begin_fields(Out& os, kv_format f) {
+    if (f == kv_format::json) {
+        os.put('{');
+    }
+}
+
+template <typename Out>
+void put_key(Out& os, std::string_view name, bool first, kv_format f) {
+    if (f == kv_format::json) {
+        if (!first) {
+            os.put(',');
+        }
+        os.put('"');
+        os.write(name.data(), static_cast<std::streamsize>(name.size()));
+        os.write("\":", 2);
+    } else {
+        if (!first) {
+            os.put(' ');
+        }
+        os.write(name.data(), static_cast<std::streamsize>(name.size()));
+        os.put('=');
+    }
+}
+
+template <typename Out>
+void end_fields(Out& os, kv_format f) {
+    if (f == kv_format::json) {
+        os.put('}');
+    }
+}
+
+template <typename... Keys>
+struct key_list {};
+
+// 一种记录形状（键序列 + 值类型序列）：二进制站点编号、异步渲染和同步输出
+template <typename Keys, typename... Values>
+struct fields;
+
+template <typename... Keys, typename... Values>
+struct fields<key_list<Keys...>, Values...> {
+    static_assert(sizeof...(Keys) == sizeof...(Values));
+
+    static inline const std::uint32_t id = site_registry::instance().add(
+        std::string_view(), std::vector<arg_desc>{desc_of<Values>()...},
+        std::vector<std::string>{std::string(Keys::name)...});
+
+    // 后台线程（以及崩溃处理）：从环形缓冲区解出各个值，渲染成一行
+    template <typename Out>
+    static void render(byte_reader& r, Out& os) {
+        const kv_format f = current_kv_format();
+        bool first = true;
+        begin_fields(os, f);
+        (render_one<Keys, Values>(r, os, f, first), ...);
+        end_fields(os, f);
+        os.put('\n');
+    }
+
+    // 同步模式：直接渲染调用方的值，换行由输出端补上
+    static void write(std::ostream& os, kv_format f, const Values&... values) {
+        bool first = true;
+        begin_fields(os, f);
+        (write_one<Keys>(os, f, first, values), ...);
+        end_fields(os, f);
+    }
+
+private:
+    template <typename Key, typename T, typename Out>
+    static void render_one(byte_reader& r, Out& os, kv_format f, bool& first) {
+        put_key(os, Key::name, first, f);
+        first = false;
+        if constexpr (has_codec_v<T>) {
+            codec<T>::visit(r, [&](const auto& value) { put_field_value(os, value, f); });
+        } else {
+            codec<std::string>::visit(r, [&](std::string_view text) { put_string(os, text, f); });
+        }
+    }
+
+    template <typename Key, typename T>
+    static void write_one(std::ostream& os, kv_format f, bool& first, const T& value) {
+        put_key(os, Key::name, first, f);
+        first = false;
+        if constexpr (has_codec_v<T>) {
+            put_field_value(os, value, f);
+        } else {
+            std::ostringstream text;
+            Logger<T>::format(text, value);
+            put_string(os, text.view(), f);
+        }
+    }
+};
+
+template <typename Record, typename... Values>
+bool capture_fields(const Values&... values) {
+    if (!async_enabled()) {
+        return false;
+    }
+    static constexpr record_format text{&Record::template render<std::ostream>,
+                                        &Record::template render<emergency_writer>};
+    const record_format* format = async_backend::instance().binary() ? &binary_record<Record, Values...> : &text;
+    return capture_encoded(format, std::index_sequence_for<Values...>{}, values...);
+}
+
+template <severity S, typename Record, typename... Values>
+void write_fields(const Values&... values) {
+    if (capture_fields<Record>(values...)) {
+        committed<S>();
+    } else {
+        write_line<S>([&](std::ostream& os) { Record::write(os, current_kv_format(), values...); });
+    }
+}
+
+template <severity S, typename... Args, std::size_t... I>
+void log_fields(std::index_sequence<I...>, const std::tuple<const Args&...>& args) {
+    using all = std::tuple<Args...>;
+    static_assert((is_key<std::tuple_element_t<2 * I, all>>::value && ...),
+                  "logKV arguments alternate \"name\"_key and value");
+    using record = fields<key_list<std::tuple_element_t<2 * I, all>...>, std::tuple_element_t<2 * I + 1, all>...>;
+    write_fields<S, record>(std::get<2 * I + 1>(args)...);
+}
+
+} // namespace detail
+
+} // namespace logging
+
+// logKV("user"_key, id, "latency_us"_key, t)：键值对组成的一条记录，级别用法同 logAll
+template <logging::severity S = logging::severity::info, typename... Args>
+void logKV(const Args&... args) {
+    static_assert(sizeof...(Args) > 0 && sizeof...(Args) % 2 == 0, "logKV takes \"name\"_key, value pairs");
+    if constexpr (logging::compiled_in<S>) {
+        if (!logging::enabled<S>()) {
+            return;
+        }
+        logging::detail::log_fields<S>(std::make_index_sequence<sizeof...(Args) / 2>{}, std::forward_as_tuple(args...));
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+
+// 日志级别：编译期下限 + 运行期阈值。
+// 低于编译期下限的调用在 if constexpr 里整段丢弃，不生成任何代码；
+// 运行期阈值只能在下限之上调高或调低，读写都是无锁的 relaxed 原子操作
+//
+// 编译期下限由 LOGGING_MIN_SEVERITY 指定（0 trace … 5 fatal，6 全部关闭），
+// 未指定时 Release（NDEBUG）构建为 info，其余为 trace
+#ifndef LOGGING_MIN_SEVERITY
+#ifdef NDEBUG
+#define LOGGING_MIN_SEVERITY 2
+#else
+#define LOGGING_MIN_SEVERITY 0
+#endif
+#endif
+
+namespace logging {
+
+enum class severity : int { trace, debug, info, warn, error, fatal, off };
+
+inline constexpr severity min_severity = static_cast<severity>(LOGGING_MIN_SEVERITY);
+
+namespace detail {
+
+inline std::atomic<severity> runtime_threshold{min_severity};
+
+} // namespace detail
+
+// 低于编译期下限的级别不可能被输出
+template <severity S>
+inline constexpr bool compiled_in = S >= min_severity && S != severity::off;
+
+inline void set_threshold(severity s) {
+    detail::runtime_threshold.store(s, std::memory_order_relaxed);
+}
+
+inline severity threshold() {
+    return detail::runtime_threshold.load(std::memory_order_relaxed);
+}
+
+template <severity S>
+inline bool enabled() {
+    if constexpr (!compiled_in<S>) {
+        return false;
+    } else {
+        return S >= threshold();
+    }
+}
+
+// 参数本身计算代价高时用它包住整段日志：级别被滤掉时 f 不会被调用，
+// 低于编译期下限时连判断都没有，内联后 f 及其中的参数表达式不留下任何代码
+template <severity S, typename F>
+inline void when(F&& f) {
+    if constexpr (compiled_in<S>) {
+        if (enabled<S>()) {
+            f();
+        }
+    }
+}
+
+} // namespace logging
@@ -0,0 +1,406 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define LOGGING_HAS_MMAP 1
+#else
+#define LOGGING_HAS_MMAP 0
+#endif
+
+// 内存映射的滚动日志文件：每个分段是预先分配、映射好的文件，
+// 写入线程只做一次原子加法占位再 memcpy，不加锁也不进内核。
+// 后台线程负责预先映射并触页下一个分段、定期 msync(MS_ASYNC)、
+// 以及把写完的分段截到实际长度后解除映射。
+// 分段文件名为 path.000000、path.000001 …，截断后就是普通文本文件；
+// 重新打开时接着目录里已有的最大编号往后编，从不覆盖上一次运行留下的分段
+namespace logging {
+
+struct mapped_file_options {
+    std::string path = "app.log";
+    std::size_t segment_bytes = std::size_t(64) << 20;
+    std::chrono::seconds rotate_interval{3600};   // 分段打开超过这么久就滚动（有内容时）
+    std::chrono::milliseconds sync_interval{1000}; // 后台 msync(MS_ASYNC) 的间隔
+};
+
+#if LOGGING_HAS_MMAP
+
+class mapped_file {
+public:
+    static std::shared_ptr<mapped_file> open(const mapped_file_options& options) {
+        return std::shared_ptr<mapped_file>(new mapped_file(options));
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    ~mapped_file() { close(); }
+
+    // 本次打开后创建的第一个分段的文件名
+    const std::string& first_segment() const { return first_segment_; }
+
+    // 任意线程并发调用。超过一个分段的数据（比如异步后端的一整批）尽量在换行处切开分几次写
+    void write(const char* data, std::size_t n) {
+        while (n > options_.segment_bytes) {
+            std::size_t k = options_.segment_bytes;
+            while (k > 0 && data[k - 1] != '\n') {
+                --k;
+            }
+            if (k == 0) {
+                k = options_.segment_bytes;
+            }
+            write_chunk(data, k);
+            data += k;
+            n -= k;
+        }
+        write_chunk(data, n);
+    }
+
+    // 崩溃处理用：只写进当前分段，放不下就返回 false，不换段、不加锁、不等待
+    bool emergency_write(const char* data, std::size_t n) {
+        segment* s = current_.load(std::memory_order_acquire);
+        if (!s) {
+            return false;
+        }
+        const std::uint64_t offset = s->reserved.fetch_add(n, std::memory_order_relaxed);
+        if (offset + n > s->capacity) {
+            return false;
+        }
+        std::memcpy(s->base + offset, data, n);
+        s->committed.fetch_add(n, std::memory_order_release);
+        return true;
+    }
+
+    // 请求内核异步写回当前分段已写完的部分；进程崩溃时页缓存里的内容不会丢
+    void flush() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sync_current();
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_) {
+                return;
+            }
+            stop_ = true;
+        }
+        wake_.notify_all();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+        if (segment* s = current_.exchange(nullptr, std::memory_order_acq_rel)) {
+            const std::uint64_t offset = s->reserved.fetch_add(s->capacity + 1, std::memory_order_relaxed);
+            const std::uint64_t end = offset < s->capacity ? offset : s->capacity;
+            while (s->committed.load(std::memory_order_acquire) < end) {
+                std::this_thread::yield();
+            }
+            retire(*s, end);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const retiring& r : retiring_) {
+            retire(*r.s, r.end);
+        }
+        retiring_.clear();
+        if (next_) {
+            discard(*next_);
+            next_ = nullptr;
+        }
+    }
+
+private:
+    struct segment {
+        int fd = -1;
+        char* base = nullptr;
+        std::uint64_t capacity = 0;
+        std::string name;
+        std::chrono::steady_clock::time_point opened;
+        std::uint64_t synced = 0; // 已请求写回的长度，由 mutex_ 保护
+        std::atomic<std::uint64_t> reserved{0};
+        std::atomic<std::uint64_t> committed{0};
+    };
+
+    struct retiring {
+        segment* s;
+        std::uint64_t end;
+    };
+
+    explicit mapped_file(const mapped_file_options& options) : options_(options) {
+        const long page = ::sysconf(_SC_PAGESIZE);
+        page_ = page > 0 ? static_cast<std::size_t>(page) : 4096;
+        options_.segment_bytes = (options_.segment_bytes + page_ - 1) / page_ * page_;
+        next_index_ = first_free_index();
+        segment* first = prepare();
+        first_segment_ = first->name;
+        first->opened = std::chrono::steady_clock::now();
+        current_.store(first, std::memory_order_release);
+        worker_ = std::thread([this] { worker_loop(); });
+    }
+
+    // 目录里已有的 path.NNNNNN 的最大编号加一；目录不存在或读不了时从 0 开始，由 open 报告错误
+    std::uint64_t first_free_index() const {
+        const std::string::size_type slash = options_.path.rfind('/');
+        const std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : options_.path.substr(0, slash);
+        const std::string prefix = (slash == std::string::npos ? options_.path : options_.path.substr(slash + 1)) + ".";
+        std::uint64_t next = 0;
+        DIR* d = ::opendir(dir.c_str());
+        if (!d) {
+            return next;
+        }
+        while (const dirent* entry = ::readdir(d)) {
+            const char* name = entry->d_name;
+            if (std::strncmp(name, prefix.c_str(), prefix.size()) != 0) {
+                continue;
+            }
+            const char* digits = name + prefix.size();
+            const std::size_t len = std::strlen(digits);
+            if (len < 6 || std::strspn(digits, "0123456789") != len) {
+                continue;
+            }
+            const std::uint64_t index = std::strtoull(digits, nullptr, 10);
+            if (index >= next) {
+                next = index + 1;
+            }
+        }
+        ::closedir(d);
+        return next;
+    }
+
+    // 创建、预分配并映射下一个分段，逐页写一次把缺页都提前触发掉。
+    // O_EXCL：编号已被占用（比如另一个进程同时在写同一路径）就换下一个编号，不覆盖已有文件
+    segment* prepare() {
+        auto s = std::make_unique<segment>();
+        s->capacity = options_.segment_bytes;
+        for (;;) {
+            std::uint64_t index;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                index = next_index_++;
+            }
+            char suffix[24];
+            std::snprintf(suffix, sizeof(suffix), ".%06llu", static_cast<unsigned long long>(index));
+            s->name = options_.path + suffix;
+            s->fd = ::open(s->name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+            if (s->fd >= 0) {
+                break;
+            }
+            if (errno != EEXIST) {
+                throw std::system_error(errno, std::generic_category(), "open " + s->name);
+            }
+        }
+        if (::ftruncate(s->fd, static_cast<off_t>(s->capacity)) != 0) {
+            const int err = errno;
+            ::close(s->fd);
+            ::unlink(s->name.c_str()); // 是本次新建的空文件
+            throw std::system_error(err, std::generic_category(), "ftruncate " + s->name);
+        }
+        void* base = ::mmap(nullptr, s->capacity, PROT_READ | PROT_WRITE, MAP_SHARED, s->fd, 0);
+        if (base == MAP_FAILED) {
+            const int err = errno;
+            ::close(s->fd);
+            ::unlink(s->name.c_str()); // 是本次新建的空文件
+            throw std::system_error(err, std::generic_category(), "mmap " + s->name);
+        }
+        s->base = static_cast<char*>(base);
+        for (std::size_t offset = 0; offset < s->capacity; offset += page_) {
+            static_cast<volatile char*>(s->base)[offset] = 0;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        segments_.push_back(std::move(s));
+        return segments_.back().get();
+    }
+
+    void write_chunk(const char* data, std::size_t n) {
+        for (;;) {
+            segment* s = current_.load(std::memory_order_acquire);
+            if (!s) {
+                return; // 已关闭
+            }
+            const std::uint64_t offset = s->reserved.fetch_add(n, std::memory_order_relaxed);
+            if (offset + n <= s->capacity) {
+                std::memcpy(s->base + offset, data, n);
+                s->committed.fetch_add(n, std::memory_order_release);
+                return;
+            }
+            if (offset <= s->capacity) {
+                rotate(s, offset); // 第一个越界的写入者负责封口
+            } else {
+                while (current_.load(std::memory_order_acquire) == s) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    // 封口者：等先占位的写入者写完，换上预备好的分段，旧分段交给后台线程收尾
+    void rotate(segment* s, std::uint64_t end) {
+        while (s->committed.load(std::memory_order_acquire) < end) {
+            std::this_thread::yield();
+        }
+        segment* next = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            next = next_;
+            next_ = nullptr;
+        }
+        if (!next) {
+            try {
+                next = prepare(); // 后台线程还没来得及预备
+            } catch (const std::system_error& e) {
+                // 建不了新分段就停止写文件，正在等换段的写入者看到空指针后返回
+                std::fprintf(stderr, "[logger] %s\n", e.what());
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    retiring_.push_back({s, end});
+                }
+                current_.store(nullptr, std::memory_order_release);
+                wake_.notify_all();
+                return;
+            }
+        }
+        next->opened = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            retiring_.push_back({s, end});
+        }
+        current_.store(next, std::memory_order_release);
+        wake_.notify_all();
+    }
+
+    void worker_loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            // 持锁收尾，flush 里的 sync_current 不会碰到正在解除映射的分段
+            for (const retiring& r : retiring_) {
+                retire(*r.s, r.end);
+            }
+            retiring_.clear();
+            const bool need_next = !next_;
+            lock.unlock();
+
+            segment* prepared = nullptr;
+            if (need_next) {
+                try {
+                    prepared = prepare();
+                } catch (const std::system_error&) {
+                    // 下个周期再试；真到换段时由封口者同步创建并报告错误
+                }
+            }
+            rotate_if_stale();
+
+            lock.lock();
+            if (prepared) {
+                if (stop_ || next_) {
+                    discard(*prepared);
+                } else {
+                    next_ = prepared;
+                }
+            }
+            sync_current();
+            wake_.wait_for(lock, options_.sync_interval,
+                           [&] { return stop_ || !retiring_.empty() || !next_; });
+        }
+    }
+
+    // 时间滚动：像一次超大的写入那样占满剩余空间，由封口者的同一条路径完成
+    void rotate_if_stale() {
+        segment* s = current_.load(std::memory_order_acquire);
+        if (!s || s->reserved.load(std::memory_order_relaxed) == 0 ||
+            std::chrono::steady_clock::now() - s->opened < options_.rotate_interval) {
+            return;
+        }
+        const std::uint64_t offset = s->reserved.fetch_add(s->capacity + 1, std::memory_order_relaxed);
+        if (offset <= s->capacity) {
+            rotate(s, offset);
+        }
+    }
+
+    // 调用方持有 mutex_
+    void sync_current() {
+        segment* s = current_.load(std::memory_order_acquire);
+        if (!s) {
+            return;
+        }
+        std::uint64_t end = s->committed.load(std::memory_order_acquire);
+        end = (end + page_ - 1) / page_ * page_;
+        if (end > s->synced) {
+            ::msync(s->base + s->synced / page_ * page_, end - s->synced / page_ * page_, MS_ASYNC);
+            s->synced = end;
+        }
+    }
+
+    // 分段结构本身一直保留到关闭：换段之后仍可能有迟到的写入者对它做 fetch_add
+    void retire(segment& s, std::uint64_t end) {
+        ::msync(s.base, s.capacity, MS_ASYNC);
+        ::munmap(s.base, s.capacity);
+        s.base = nullptr;
+        if (::ftruncate(s.fd, static_cast<off_t>(end)) != 0) {
+            std::fprintf(stderr, "[logger] cannot truncate %s, tail is zero-filled\n", s.name.c_str());
+        }
+        ::close(s.fd);
+        s.fd = -1;
+    }
+
+    void discard(segment& s) {
+        ::munmap(s.base, s.capacity);
+        s.base = nullptr;
+        ::close(s.fd);
+        s.fd = -1;
+        ::unlink(s.name.c_str());
+    }
+
+    mapped_file_options options_;
+    std::string first_segment_;
+    std::size_t page_ = 4096;
+    std::atomic<segment*> current_{nullptr};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<std::unique_ptr<segment>> segments_;
+    std::deque<retiring> retiring_;
+    segment* next_ = nullptr;
+    std::uint64_t next_index_ = 0;
+    bool stop_ = false;
+    std::thread worker_;
+};
+
+#else
+
+// 没有 mmap 的平台上无法打开
+class mapped_file {
+public:
+    static std::shared_ptr<mapped_file> open(const mapped_file_options&) {
+        throw std::runtime_error("mapped_file requires mmap");
+    }
+
+    const std::string& first_segment() const { return first_segment_; }
+    void write(const char*, std::size_t) {}
+    bool emergency_write(const char*, std::size_t) { return false; }
+    void flush() {}
+    void close() {}
+
+private:
+    std::string first_segment_;
+};
+
+#endif
+
+} // namespace logging
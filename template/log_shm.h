@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LOGGING_HAS_SHM 1
+#else
+#include <stdexcept>
+#define LOGGING_HAS_SHM 0
+#endif
+
+// 共享内存字节环：应用进程的异步后端把二进制日志流写进来，
+// 独立的 logcollect 进程读出、格式化并写文件。
+// 单生产者（后端线程）/ 单消费者（收集进程），头尾指针是共享内存里的无锁原子变量。
+// 应用崩溃后已经进入环的字节仍留在共享内存对象里，收集进程照常读完
+namespace logging {
+
+inline constexpr char shm_magic[8] = {'T', 'L', 'O', 'G', 'S', 'H', 'M', '\x01'};
+
+#if LOGGING_HAS_SHM
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared-memory ring needs lock-free 64-bit atomics");
+static_assert(std::atomic<std::int64_t>::is_always_lock_free, "shared-memory ring needs lock-free 64-bit atomics");
+
+namespace detail {
+
+struct shm_header {
+    char magic[8];
+    std::uint64_t capacity;                // 数据区字节数，2 的幂
+    std::atomic<std::int64_t> producer{0}; // 生产者进程号，正常关闭后为 0
+    alignas(64) std::atomic<std::uint64_t> head{0};
+    alignas(64) std::atomic<std::uint64_t> tail{0};
+};
+
+inline constexpr std::size_t shm_data_offset = 256;
+static_assert(sizeof(shm_header) <= shm_data_offset);
+
+inline std::string shm_path(const std::string& name) {
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+} // namespace detail
+
+class shm_ring {
+public:
+    // 生产者：删掉同名的旧对象（仍在读它的收集进程不受影响），新建并初始化
+    static std::unique_ptr<shm_ring> create(const std::string& name, std::size_t bytes) {
+        const std::string path = detail::shm_path(name);
+        std::size_t capacity = 4096;
+        while (capacity < bytes) {
+            capacity *= 2;
+        }
+        ::shm_unlink(path.c_str());
+        const int fd = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open " + path);
+        }
+        const std::size_t size = detail::shm_data_offset + capacity;
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            const int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "ftruncate " + path);
+        }
+        std::unique_ptr<shm_ring> ring(new shm_ring(fd, size));
+        detail::shm_header* h = new (ring->base_) detail::shm_header;
+        h->capacity = capacity;
+        h->producer.store(static_cast<std::int64_t>(::getpid()), std::memory_order_relaxed);
+        // 魔数最后写，收集进程看到它才认为头部可用
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(h->magic, shm_magic, sizeof(shm_magic));
+        return ring;
+    }
+
+    // 消费者：打开已有对象；对象不存在或还没初始化完时返回空指针
+    static std::unique_ptr<shm_ring> open(const std::string& name) {
+        const std::string path = detail::shm_path(name);
+        const int fd = ::shm_open(path.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            return nullptr;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) <= detail::shm_data_offset) {
+            ::close(fd);
+            return nullptr;
+        }
+        std::unique_ptr<shm_ring> ring(new shm_ring(fd, static_cast<std::size_t>(st.st_size)));
+        const detail::shm_header* h = ring->header();
+        if (std::memcmp(h->magic, shm_magic, sizeof(shm_magic)) != 0 ||
+            detail::shm_data_offset + h->capacity != ring->size_) {
+            return nullptr;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return ring;
+    }
+
+    static void unlink(const std::string& name) {
+        ::shm_unlink(detail::shm_path(name).c_str());
+    }
+
+    shm_ring(const shm_ring&) = delete;
+    shm_ring& operator=(const shm_ring&) = delete;
+
+    ~shm_ring() {
+        if (base_) {
+            ::munmap(base_, size_);
+        }
+        ::close(fd_);
+    }
+
+    // 生产者：整块写入，空间不够时不写并返回 false，绝不等待
+    bool write(const void* data, std::size_t n) {
+        detail::shm_header* h = header();
+        const std::uint64_t head = h->head.load(std::memory_order_relaxed);
+        const std::uint64_t tail = h->tail.load(std::memory_order_acquire);
+        if (h->capacity - (head - tail) < n) {
+            return false;
+        }
+        const std::size_t at = static_cast<std::size_t>(head & (h->capacity - 1));
+        const std::size_t first = std::min<std::size_t>(n, h->capacity - at);
+        std::memcpy(bytes() + at, data, first);
+        std::memcpy(bytes(), static_cast<const unsigned char*>(data) + first, n - first);
+        h->head.store(head + n, std::memory_order_release);
+        return true;
+    }
+
+    // 生产者正常退出时调用
+    void close_producer() { header()->producer.store(0, std::memory_order_release); }
+
+    // 消费者：把当前可读的字节（最多两段）交给 f(data, n)，返回读到的字节数
+    template <typename F>
+    std::size_t drain(F&& f) {
+        detail::shm_header* h = header();
+        const std::uint64_t tail = h->tail.load(std::memory_order_relaxed);
+        const std::uint64_t head = h->head.load(std::memory_order_acquire);
+        const std::size_t n = static_cast<std::size_t>(head - tail);
+        if (n == 0) {
+            return 0;
+        }
+        const std::size_t at = static_cast<std::size_t>(tail & (h->capacity - 1));
+        const std::size_t first = std::min<std::size_t>(n, h->capacity - at);
+        f(bytes() + at, first);
+        if (n > first) {
+            f(bytes(), n - first);
+        }
+        h->tail.store(head, std::memory_order_release);
+        return n;
+    }
+
+    // 生产者进程仍在运行且没有正常关闭
+    bool producer_alive() const {
+        const std::int64_t pid = header()->producer.load(std::memory_order_acquire);
+        return pid != 0 && (::kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM);
+    }
+
+    // name 现在指向的是否还是这个对象（生产者重启后会换成新的）
+    bool is_current(const std::string& name) const {
+        const int fd = ::shm_open(detail::shm_path(name).c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat now, mine;
+        const bool same = ::fstat(fd, &now) == 0 && ::fstat(fd_, &mine) == 0 && now.st_dev == mine.st_dev &&
+                          now.st_ino == mine.st_ino;
+        ::close(fd);
+        return same;
+    }
+
+private:
+    shm_ring(int fd, std::size_t size) : fd_(fd), size_(size) {
+        void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            const int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "mmap shared ring");
+        }
+        base_ = static_cast<unsigned char*>(base);
+    }
+
+    detail::shm_header* header() const { return reinterpret_cast<detail::shm_header*>(base_); }
+    unsigned char* bytes() const { return base_ + detail::shm_data_offset; }
+
+    int fd_;
+    std::size_t size_;
+    unsigned char* base_ = nullptr;
+};
+
+#else
+
+// 没有 POSIX 共享内存的平台上无法创建
+class shm_ring {
+public:
+    static std::unique_ptr<shm_ring> create(const std::string&, std::size_t) {
+        throw std::runtime_error("shm_ring requires POSIX shared memory");
+    }
+
+    static void unlink(const std::string&) {}
+
+    bool write(const void*, std::size_t) { return false; }
+    void close_producer() {}
+};
+
+#endif
+
+} // namespace logging
@@ -0,0 +1,454 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "log_level.h"
+#include "log_mmap.h"
+#include "log_uring.h"
+#include "num_format.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <climits>
+#include <poll.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#define LOGGING_HAS_WRITEV 1
+#else
+#define LOGGING_HAS_WRITEV 0
+#endif
+
+// 日志输出端：格式化好的文本先进一块大缓冲区，按刷新策略整块写给目标流，
+// 一批只调用一次 write。同步日志和异步后端共用同一个输出端，保证两者输出顺序一致。
+// line 策略下目标有文件描述符时，logAll 的同步记录可以绕过缓冲区，用一次 writev 直接写出（见 log_gather.h）
+namespace logging {
+
+// 何时把缓冲区写出
+//   line   : 每行（异步模式下每批）写出，与原来的 std::endl 行为一致
+//   size   : 缓冲区写满才写出
+//   time   : 距上次写出超过 interval 时写出；配置成 time 时输出端起一个计时线程，
+//            没有新日志的时候缓冲区里的内容也最多停留 interval
+//   manual : 只在 logging::flush() 或缓冲区写满时写出
+// 无论哪种策略，fatal 级别的日志写完立即刷新，程序正常退出时也会刷新
+enum class flush_policy { line, size, time, manual };
+
+struct sink_options {
+    flush_policy policy = flush_policy::line;
+    std::size_t buffer_bytes = std::size_t(1) << 16;
+    std::chrono::milliseconds interval{100};
+    std::ostream* target = &std::cout;
+    // target 对应的文件描述符，用于 writev 直接写出；-1 时 std::cout 为 1、std::cerr / std::clog 为 2，
+    // 其余目标没有可用的描述符，始终经过缓冲区
+    int fd = -1;
+    // 非空时改写到内存映射的滚动文件：每行在调用线程格式化后直接拷进映射区，
+    // 不经过上面的缓冲区和锁，flush 只请求内核异步写回
+    std::shared_ptr<mapped_file> file;
+    // 非空时改写到 io_uring 异步文件（file 为空时才生效）：调用线程格式化后只拷进它的缓冲池，
+    // 写出由它的后台线程批量提交
+    std::shared_ptr<uring_file> uring;
+};
+
+namespace detail {
+
+#if LOGGING_HAS_WRITEV
+// 写完整组 iovec：一次最多交给内核 IOV_MAX 段，只写了一部分时从断点继续；
+// 非阻塞描述符暂时写不进去时 poll 等它可写。其余错误（EPIPE、ENOSPC 等）或写出 0 字节时返回 false
+inline bool write_vectored(int fd, iovec* iov, std::size_t count) {
+#ifdef IOV_MAX
+    constexpr std::size_t max_segments = IOV_MAX;
+#else
+    constexpr std::size_t max_segments = 16;
+#endif
+    while (count > 0) {
+        const ssize_t k = ::writev(fd, iov, static_cast<int>(count < max_segments ? count : max_segments));
+        if (k < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                pollfd p{fd, POLLOUT, 0};
+                if (::poll(&p, 1, -1) >= 0 || errno == EINTR) {
+                    continue;
+                }
+            }
+            return false;
+        }
+        if (k == 0) {
+            return false;
+        }
+        auto n = static_cast<std::size_t>(k);
+        while (count > 0 && n >= iov->iov_len) {
+            n -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + n;
+            iov->iov_len -= n;
+        }
+    }
+    return true;
+}
+
+// 程序启动时标准流的缓冲区。std::cout 等被 rdbuf(...) 换掉之后就不再对应 1 / 2 号描述符。
+// 与其他静态变量的初始化顺序不确定，先构造一个 ios_base::Init 保证标准流已经就绪
+struct standard_buffers {
+    std::ios_base::Init init;
+    std::streambuf* out = std::cout.rdbuf();
+    std::streambuf* err = std::cerr.rdbuf();
+    std::streambuf* log = std::clog.rdbuf();
+};
+
+inline const standard_buffers startup_buffers;
+#endif
+
+// 写满或 sync 时把整块内容交给目标流并立刻刷新
+class sink_buffer : public std::streambuf {
+public:
+    void reset(std::size_t bytes, std::ostream* target) {
+        drain();
+        target_ = target;
+        buffer_.assign(bytes < 256 ? 256 : bytes, '\0');
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+    }
+
+    bool empty() const { return pptr() == pbase(); }
+
+    // 还没写出的内容
+    std::string_view pending() const { return std::string_view(pbase(), static_cast<std::size_t>(pptr() - pbase())); }
+
+protected:
+    int_type overflow(int_type ch) override {
+        drain();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override {
+        drain();
+        return 0;
+    }
+
+private:
+    void drain() {
+        const std::ptrdiff_t n = pptr() - pbase();
+        if (n > 0 && target_) {
+            target_->write(pbase(), n);
+            target_->flush();
+        }
+        setp(buffer_.data(), buffer_.data() + buffer_.size());
+    }
+
+    std::vector<char> buffer_;
+    std::ostream* target_ = nullptr;
+};
+
+// 直写文件时每个线程格式化一行用的缓冲区：clear 只回到开头，容量一直保留，
+// 稳定之后格式化一行不再分配内存
+class line_buffer : public std::streambuf {
+public:
+    void clear() { setp(data_.data(), data_.data() + data_.size()); }
+
+    std::string_view view() const { return std::string_view(pbase(), static_cast<std::size_t>(pptr() - pbase())); }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (traits_type::eq_int_type(ch, traits_type::eof())) {
+            return traits_type::not_eof(ch);
+        }
+        grow(1);
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+        return ch;
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        grow(static_cast<std::size_t>(n));
+        std::char_traits<char>::copy(pptr(), s, static_cast<std::size_t>(n));
+        pbump(static_cast<int>(n));
+        return n;
+    }
+
+private:
+    // 保证还能再放 n 个字符
+    void grow(std::size_t n) {
+        const std::size_t used = static_cast<std::size_t>(pptr() - pbase());
+        if (data_.size() - used >= n) {
+            return;
+        }
+        std::size_t size = data_.size() < 256 ? 256 : data_.size();
+        while (size - used < n) {
+            size *= 2;
+        }
+        data_.resize(size);
+        setp(data_.data(), data_.data() + data_.size());
+        pbump(static_cast<int>(used));
+    }
+
+    std::vector<char> data_;
+};
+
+class sink {
+public:
+    static sink& instance() {
+        static sink s;
+        return s;
+    }
+
+    ~sink() {
+        stop_timer();
+        flush();
+    }
+
+    void configure(const sink_options& options) {
+        std::lock_guard<std::mutex> config_lock(config_mutex_);
+        stop_timer();
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 旧文件可能仍有写入线程持有裸指针，留到输出端析构时再释放
+        if (options_.file) {
+            retired_files_.push_back(options_.file);
+        }
+        if (options_.uring) {
+            retired_urings_.push_back(options_.uring);
+        }
+        options_ = options;
+        file_.store(options_.file.get(), std::memory_order_release);
+        uring_.store(options_.file ? nullptr : options_.uring.get(), std::memory_order_release);
+        gather_fd_.store(resolve_gather_fd(), std::memory_order_relaxed);
+        buffer_.reset(options_.buffer_bytes, options_.target);
+        last_flush_ = std::chrono::steady_clock::now();
+        if (options_.policy == flush_policy::time) {
+            timer_stop_ = false;
+            timer_ = std::thread([this] { timer_loop(); });
+        }
+    }
+
+    // 写一行：write(os) 负责内容，换行由这里补上
+    template <typename F>
+    void line(F&& write, bool force_flush) {
+        if (mapped_file* file = file_.load(std::memory_order_acquire)) {
+            line_direct(*file, write, force_flush);
+            return;
+        }
+        if (uring_file* uring = uring_.load(std::memory_order_acquire)) {
+            line_direct(*uring, write, force_flush);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        write(stream_);
+        stream_.put('\n');
+        settle(force_flush);
+    }
+
+#if LOGGING_HAS_WRITEV
+    // 可以直接 writev 时返回目标的文件描述符，否则为 -1；只作预判，gather 在锁内还会再确认
+    int gather_fd() const { return gather_fd_.load(std::memory_order_relaxed); }
+
+    // 一条已拆成若干段的记录：先写出缓冲区和目标流里已有的内容保证顺序，再一次 writev。
+    // 配置已经变得不适用、或推断出描述符的标准流之后被 rdbuf 重定向时返回 false，调用方改走 line。
+    // 写出失败的记录计数，下一次写出成功时补一行 "[logger] N records lost"
+    bool gather(iovec* iov, std::size_t count) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const int fd = gather_fd_.load(std::memory_order_relaxed);
+        if (fd < 0 || (gather_buf_ && options_.target->rdbuf() != gather_buf_)) {
+            return false;
+        }
+        flush_locked();
+        options_.target->flush();
+        if (!write_vectored(fd, iov, count)) {
+            ++lost_records_;
+        } else if (lost_records_ > 0) {
+            char note[64];
+            char* p = std::char_traits<char>::copy(note, "[logger] ", 9) + 9;
+            p = numfmt::write(p, lost_records_);
+            p = std::char_traits<char>::copy(p, " records lost\n", 14) + 14;
+            iovec line{note, static_cast<std::size_t>(p - note)};
+            if (write_vectored(fd, &line, 1)) {
+                lost_records_ = 0;
+            }
+        }
+        return true;
+    }
+#endif
+
+    // 异步后端的一批已格式化文本
+    void write(const char* data, std::size_t n) {
+        if (mapped_file* file = file_.load(std::memory_order_acquire)) {
+            file->write(data, n);
+            return;
+        }
+        if (uring_file* uring = uring_.load(std::memory_order_acquire)) {
+            uring->write(data, n);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        stream_.write(data, static_cast<std::streamsize>(n));
+        settle(false);
+    }
+
+    void flush() {
+        if (mapped_file* file = file_.load(std::memory_order_acquire)) {
+            file->flush();
+        }
+        if (uring_file* uring = uring_.load(std::memory_order_acquire)) {
+            uring->flush();
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        flush_locked();
+    }
+
+    // 以下供崩溃处理使用，不加锁：另一个线程可能正在写，读到的是尽力而为的快照
+    std::string_view emergency_pending() const { return buffer_.pending(); }
+    const std::ostream* emergency_target() const { return options_.target; }
+    mapped_file* emergency_file() const { return file_.load(std::memory_order_acquire); }
+    uring_file* emergency_uring() const { return uring_.load(std::memory_order_acquire); }
+
+private:
+    sink() : stream_(&buffer_) {
+        buffer_.reset(options_.buffer_bytes, options_.target);
+        gather_fd_.store(resolve_gather_fd(), std::memory_order_relaxed);
+    }
+
+    // time 策略的计时线程：睡到上次写出之后 interval 再检查，写入时已经刷新过就接着睡
+    void timer_loop() {
+        const std::chrono::milliseconds interval =
+            options_.interval > std::chrono::milliseconds(1) ? options_.interval : std::chrono::milliseconds(1);
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!timer_stop_) {
+            timer_wake_.wait_until(lock, last_flush_ + interval);
+            if (!timer_stop_ && !buffer_.empty() &&
+                std::chrono::steady_clock::now() - last_flush_ >= options_.interval) {
+                flush_locked();
+            }
+        }
+    }
+
+    // 调用方不能持有 mutex_：计时线程刷新时要拿它
+    void stop_timer() {
+        if (!timer_.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            timer_stop_ = true;
+        }
+        timer_wake_.notify_all();
+        timer_.join();
+    }
+
+    // 映射文件和 io_uring 文件：每行在调用线程格式化后直接交给文件，不经过上面的缓冲区和锁
+    template <typename File, typename F>
+    static void line_direct(File& file, F& write, bool force_flush) {
+        thread_local line_buffer buffer;
+        thread_local std::ostream text(&buffer);
+        buffer.clear();
+        text.clear();
+        write(text);
+        text.put('\n');
+        const std::string_view out = buffer.view();
+        file.write(out.data(), out.size());
+        if (force_flush) {
+            file.flush();
+        }
+    }
+
+    // 只有 line 策略、没有映射文件或 io_uring 文件、目标有描述符时才走 writev：其余策略要的正是缓冲区的攒批。
+    // 推断出的描述符只在标准流仍用启动时的缓冲区时有效，重定向可能发生在配置之后，由 gather 每次在锁内核对
+    int resolve_gather_fd() {
+        gather_buf_ = nullptr;
+        const sink_options& options = options_;
+        if (!LOGGING_HAS_WRITEV || options.policy != flush_policy::line || options.file || options.uring ||
+            !options.target) {
+            return -1;
+        }
+        if (options.fd >= 0) {
+            return options.fd;
+        }
+#if LOGGING_HAS_WRITEV
+        if (options.target == &std::cout) {
+            gather_buf_ = startup_buffers.out;
+            return 1;
+        }
+        if (options.target == &std::cerr || options.target == &std::clog) {
+            gather_buf_ = options.target == &std::cerr ? startup_buffers.err : startup_buffers.log;
+            return 2;
+        }
+        return -1;
+#else
+        return -1;
+#endif
+    }
+
+    void settle(bool force_flush) {
+        switch (options_.policy) {
+        case flush_policy::line:
+            flush_locked();
+            return;
+        case flush_policy::time:
+            if (std::chrono::steady_clock::now() - last_flush_ >= options_.interval) {
+                flush_locked();
+                return;
+            }
+            break;
+        case flush_policy::size:
+        case flush_policy::manual:
+            break;
+        }
+        if (force_flush) {
+            flush_locked();
+        }
+    }
+
+    void flush_locked() {
+        buffer_.pubsync();
+        last_flush_ = std::chrono::steady_clock::now();
+    }
+
+    std::mutex config_mutex_; // 串行化 configure，保证计时线程的启停成对；先于 mutex_ 获取
+    std::mutex mutex_;
+    sink_options options_;
+    sink_buffer buffer_;
+    std::ostream stream_;
+    std::chrono::steady_clock::time_point last_flush_ = std::chrono::steady_clock::now();
+    std::atomic<mapped_file*> file_{nullptr};
+    std::atomic<uring_file*> uring_{nullptr};
+    std::atomic<int> gather_fd_{-1};
+    std::streambuf* gather_buf_ = nullptr; // gather_fd_ 是推断出来的时候，目标流应有的缓冲区
+    std::uint64_t lost_records_ = 0;       // writev 失败的记录，由 mutex_ 保护
+    std::vector<std::shared_ptr<mapped_file>> retired_files_;
+    std::vector<std::shared_ptr<uring_file>> retired_urings_;
+    std::thread timer_;
+    std::condition_variable timer_wake_;
+    bool timer_stop_ = false; // 由 mutex_ 保护
+};
+
+// 同步输出一行
+template <severity S, typename F>
+void write_line(F&& write) {
+    sink::instance().line(std::forward<F>(write), S >= severity::fatal);
+}
+
+} // namespace detail
+
+inline void configure_sink(const sink_options& options) {
+    detail::sink::instance().configure(options);
+}
+
+} // namespace logging
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+#include "log_binary.h"
+#include "log_sink.h"
+
+// 按调用点限流：每个 (站点名, 策略) 组合一份静态状态，判断只用线程局部状态或该站点的原子变量，不加锁。
+// 被压掉的条数在每次 logging::flush() 时汇总成 "[logger] 站点名: suppressed K messages"
+namespace logging {
+
+namespace detail {
+
+// 限流用的时钟：Linux 上用 CLOCK_MONOTONIC_COARSE，比 steady_clock 便宜数倍，代价是分辨率只有毫秒级
+#if defined(__linux__)
+inline std::int64_t throttle_now() {
+    timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+inline std::int64_t throttle_clock_resolution() {
+    static const std::int64_t resolution = [] {
+        timespec ts;
+        return ::clock_getres(CLOCK_MONOTONIC_COARSE, &ts) == 0
+                   ? static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec
+                   : std::int64_t(0);
+    }();
+    return resolution;
+}
+#else
+inline std::int64_t throttle_now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+inline std::int64_t throttle_clock_resolution() {
+    return 0;
+}
+#endif
+
+} // namespace detail
+
+// 每个策略提供：
+//   state                  : 每个站点一份，只含原子变量
+//   local                  : 每个线程每个站点一份
+//   admit(state, local)    : 本次是否放行
+//   fold(state, local)     : 把本线程尚未并入的计数并进站点状态（汇总前由汇总线程调用）
+//   take_suppressed(state) : 取走自上次以来被压掉的条数（只在汇总时调用）
+
+// 采样：每个线程每 N 次放行一次（第 1、N+1、2N+1 … 次）。
+// 判断只动线程局部的倒数计数；被压掉的条数每放行一次才并进站点的原子计数，
+// 线程退出或本线程汇总时补上零头，所以汇总里可能暂缺其他运行中线程最近不足 N 条的部分
+template <std::uint64_t N>
+struct sample {
+    static_assert(N > 0, "sample<N> needs N > 0");
+
+    struct state {
+        std::atomic<std::uint64_t> suppressed{0};
+    };
+
+    struct local {
+        std::uint64_t countdown = 0;
+        std::uint64_t pending = 0;
+        std::atomic<std::uint64_t>* owner = nullptr;
+
+        ~local() {
+            if (owner && pending) {
+                owner->fetch_add(pending, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    static bool admit(state& s, local& l) {
+        if (l.countdown != 0) {
+            --l.countdown;
+            ++l.pending;
+            return false;
+        }
+        l.countdown = N - 1;
+        l.owner = &s.suppressed;
+        if (l.pending) {
+            s.suppressed.fetch_add(l.pending, std::memory_order_relaxed);
+            l.pending = 0;
+        }
+        return true;
+    }
+
+    static void fold(state& s, local& l) {
+        if (l.pending) {
+            s.suppressed.fetch_add(l.pending, std::memory_order_relaxed);
+            l.pending = 0;
+        }
+    }
+
+    static std::uint64_t take_suppressed(state& s) { return s.suppressed.exchange(0, std::memory_order_relaxed); }
+};
+
+// 令牌桶：站点内所有线程合计平均每秒 PerSecond 条，最多连续 Burst 条。
+// 用 GCRA 的形式实现，桶的全部状态是一个"理论到达时间"，一次 CAS 完成取令牌；
+// 容差额外放宽一个时钟分辨率，粗粒度时钟下长期速率仍然准确
+template <std::uint64_t PerSecond, std::uint64_t Burst = PerSecond>
+struct rate {
+    static_assert(PerSecond > 0 && Burst > 0, "rate<PerSecond, Burst> needs positive arguments");
+
+    static constexpr std::int64_t interval = std::int64_t(1000000000) / static_cast<std::int64_t>(PerSecond);
+    static constexpr std::int64_t tolerance = interval * static_cast<std::int64_t>(Burst - 1);
+
+    struct state {
+        std::atomic<std::int64_t> tat{0};
+        std::atomic<std::uint64_t> suppressed{0};
+    };
+
+    struct local {};
+
+    static bool admit(state& s, local&) {
+        const std::int64_t now = detail::throttle_now();
+        const std::int64_t limit = tolerance + detail::throttle_clock_resolution();
+        std::int64_t tat = s.tat.load(std::memory_order_relaxed);
+        for (;;) {
+            const std::int64_t base = tat > now ? tat : now;
+            if (base - now > limit) {
+                s.suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            if (s.tat.compare_exchange_weak(tat, base + interval, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+
+    static void fold(state&, local&) {}
+
+    static std::uint64_t take_suppressed(state& s) { return s.suppressed.exchange(0, std::memory_order_relaxed); }
+};
+
+namespace detail {
+
+struct throttle_entry {
+    std::string_view name;
+    std::uint64_t (*take_suppressed)();
+};
+
+class throttle_registry {
+public:
+    static throttle_registry& instance() {
+        static throttle_registry registry;
+        return registry;
+    }
+
+    bool add(const throttle_entry& entry) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.push_back(entry);
+        return true;
+    }
+
+    // 写出自上次汇总以来各站点被压掉的条数
+    void report() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const throttle_entry& e : entries_) {
+            if (const std::uint64_t k = e.take_suppressed()) {
+                sink::instance().line(
+                    [&](std::ostream& os) { os << "[logger] " << e.name << ": suppressed " << k << " messages"; },
+                    false);
+            }
+        }
+    }
+
+private:
+    throttle_registry() = default;
+
+    std::mutex mutex_;
+    std::vector<throttle_entry> entries_;
+};
+
+// 每个站点的状态，在静态初始化阶段登记到汇总表
+template <fixed_string Site, typename Policy>
+struct throttle_site {
+    static inline typename Policy::state state;
+    static inline thread_local typename Policy::local local;
+
+    static std::uint64_t take_suppressed() {
+        Policy::fold(state, local);
+        return Policy::take_suppressed(state);
+    }
+
+    static inline const bool registered = throttle_registry::instance().add({Site.view(), &take_suppressed});
+};
+
+inline void report_suppressed() {
+    throttle_registry::instance().report();
+}
+
+} // namespace detail
+
+} // namespace logging
@@ -0,0 +1,628 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LOGGING_HAS_URING_FILE 1
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define LOGGING_HAS_IO_URING 1
+#else
+#define LOGGING_HAS_IO_URING 0
+#endif
+#else
+#define LOGGING_HAS_URING_FILE 0
+#define LOGGING_HAS_IO_URING 0
+#endif
+
+// io_uring 异步日志文件：写入线程只做一次原子加法在当前缓冲区里占位再 memcpy，不加锁，也从不调用 write(2)；
+// 缓冲区写满、flush 或超过 flush_interval 时封口，按顺序分配文件偏移，交给后台线程。
+// 后台线程独占一个 io_uring：一批封口的缓冲区准备成一批 SQE，一次 io_uring_enter 提交，
+// 完成后把缓冲区放回池里。缓冲池整体注册为 fixed buffers（IORING_OP_WRITE_FIXED），
+// 内核不必每次重新固定页面；注册失败（如超过 RLIMIT_MEMLOCK）时退回普通的 IORING_OP_WRITE。
+// 内核不支持或禁用了 io_uring、或运行中 io_uring_enter 出错时，后台线程改用 pwrite 写出
+// （普通文件不能用 epoll 等就绪，所以退路是专门的写出线程），写入线程这边的行为不变。
+// 每个缓冲区带着自己的文件偏移，完成顺序与提交顺序不同也不影响文件内容；文件以追加方式续写。
+// 缓冲池全部在途时写入线程等待空闲缓冲区（磁盘跟不上时的背压），但仍不会进入 write(2)
+namespace logging {
+
+enum class uring_backend { io_uring, threads };
+
+struct uring_file_options {
+    std::string path = "app.log";
+    std::size_t buffer_bytes = std::size_t(64) << 10;
+    std::size_t buffers = 16;                        // 缓冲池大小，也是在途写入的上限
+    std::chrono::milliseconds flush_interval{100};   // 未写满的缓冲区最多停留这么久
+    bool use_io_uring = true;                        // false 时直接使用 pwrite 写出线程
+};
+
+#if LOGGING_HAS_URING_FILE
+
+namespace detail {
+
+#if LOGGING_HAS_IO_URING
+
+// 不依赖 liburing 的最小封装：一个生产者（后台线程）、一个消费者（同一线程）
+class io_ring {
+public:
+    ~io_ring() { reset(); }
+
+    bool open(unsigned entries) {
+        io_uring_params params{};
+        const long fd = ::syscall(__NR_io_uring_setup, entries, &params);
+        if (fd < 0) {
+            return false;
+        }
+        fd_ = static_cast<int>(fd);
+        sq_bytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_bytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            sq_bytes_ = cq_bytes_ = sq_bytes_ > cq_bytes_ ? sq_bytes_ : cq_bytes_;
+        }
+        sq_ = map(sq_bytes_, IORING_OFF_SQ_RING);
+        cq_ = params.features & IORING_FEAT_SINGLE_MMAP ? sq_ : map(cq_bytes_, IORING_OFF_CQ_RING);
+        sqe_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(map(sqe_bytes_, IORING_OFF_SQES));
+        if (!sq_ || !cq_ || !sqes_) {
+            reset();
+            return false;
+        }
+        char* sq = static_cast<char*>(sq_);
+        char* cq = static_cast<char*>(cq_);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    bool register_buffers(const iovec* iov, unsigned count) {
+        return ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS, iov, count) == 0;
+    }
+
+    // 调用方保证在途数不超过队列深度，SQ 不会满
+    void push_write(int fd, const char* data, std::size_t n, std::uint64_t offset, int buffer_index,
+                    std::uint64_t user_data) {
+        const unsigned tail = *sq_tail_;
+        const unsigned index = tail & sq_mask_;
+        io_uring_sqe& sqe = sqes_[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = buffer_index >= 0 ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(data);
+        sqe.len = static_cast<unsigned>(n);
+        sqe.off = offset;
+        sqe.buf_index = static_cast<std::uint16_t>(buffer_index >= 0 ? buffer_index : 0);
+        sqe.user_data = user_data;
+        sq_array_[index] = index;
+        std::atomic_ref<unsigned>(*sq_tail_).store(tail + 1, std::memory_order_release);
+        ++unsubmitted_;
+    }
+
+    // 一次系统调用提交全部新的 SQE，wait 为 true 时同时等至少一个完成。
+    // 成功返回 0，否则返回 errno：EAGAIN / EBUSY 表示完成队列满或内核暂时缺资源，
+    // 调用方应先收割完成再重试；其余错误说明这个 ring 已经不能用了
+    int enter(bool wait) {
+        for (;;) {
+            const long r = ::syscall(__NR_io_uring_enter, fd_, unsubmitted_, wait ? 1u : 0u,
+                                     wait ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+            if (r >= 0) {
+                unsubmitted_ -= static_cast<unsigned>(r) < unsubmitted_ ? static_cast<unsigned>(r) : unsubmitted_;
+                return 0;
+            }
+            if (errno != EINTR) {
+                return errno;
+            }
+        }
+    }
+
+    // 返回收割到的完成数
+    template <typename F>
+    unsigned reap(F&& on_complete) {
+        unsigned head = *cq_head_;
+        const unsigned tail = std::atomic_ref<unsigned>(*cq_tail_).load(std::memory_order_acquire);
+        const unsigned count = tail - head;
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            on_complete(cqe.user_data, cqe.res);
+        }
+        std::atomic_ref<unsigned>(*cq_head_).store(head, std::memory_order_release);
+        return count;
+    }
+
+private:
+    void* map(std::size_t bytes, long long offset) {
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        return p == MAP_FAILED ? nullptr : p;
+    }
+
+    void reset() {
+        if (sqes_) {
+            ::munmap(sqes_, sqe_bytes_);
+        }
+        if (cq_ && cq_ != sq_) {
+            ::munmap(cq_, cq_bytes_);
+        }
+        if (sq_) {
+            ::munmap(sq_, sq_bytes_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        sq_ = cq_ = nullptr;
+        sqes_ = nullptr;
+        fd_ = -1;
+    }
+
+    int fd_ = -1;
+    void* sq_ = nullptr;
+    void* cq_ = nullptr;
+    std::size_t sq_bytes_ = 0;
+    std::size_t cq_bytes_ = 0;
+    std::size_t sqe_bytes_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned unsubmitted_ = 0;
+};
+
+#endif
+
+} // namespace detail
+
+class uring_file {
+public:
+    static std::shared_ptr<uring_file> open(const uring_file_options& options) {
+        return std::shared_ptr<uring_file>(new uring_file(options));
+    }
+
+    uring_file(const uring_file&) = delete;
+    uring_file& operator=(const uring_file&) = delete;
+
+    ~uring_file() { close(); }
+
+    // io_uring 出错退回 pwrite 之后变为 threads
+    uring_backend backend() const { return backend_.load(std::memory_order_relaxed); }
+
+    // 写出失败的字节数（如磁盘已满），不会重试
+    std::uint64_t lost_bytes() const { return lost_.load(std::memory_order_relaxed); }
+
+    // 任意线程并发调用。超过一个缓冲区的数据（比如异步后端的一整批）尽量在换行处切开分几次写
+    void write(const char* data, std::size_t n) {
+        const std::size_t capacity = options_.buffer_bytes;
+        while (n > capacity) {
+            std::size_t k = capacity;
+            while (k > 0 && data[k - 1] != '\n') {
+                --k;
+            }
+            if (k == 0) {
+                k = capacity;
+            }
+            write_chunk(data, k);
+            data += k;
+            n -= k;
+        }
+        if (n > 0) {
+            write_chunk(data, n);
+        }
+    }
+
+    // 把当前缓冲区封口提交，不等待写完
+    void flush() {
+        buffer* b = current_.load(std::memory_order_acquire);
+        if (!b || b->reserved.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        const std::uint64_t offset = b->reserved.fetch_add(options_.buffer_bytes + 1, std::memory_order_relaxed);
+        if (offset <= options_.buffer_bytes) {
+            rotate(b, offset);
+        }
+    }
+
+    // 以下供崩溃处理使用，不加锁、不等待，读到的是尽力而为的快照。
+    // 进程被信号杀死时内核会取消还没完成的 io_uring 请求，所以已封口、还没回到池里的缓冲区
+    // 按各自的偏移重写一遍（内容相同，重复写无害），再把当前缓冲区接在后面；
+    // 之后的 emergency_write 继续往后写
+    void emergency_flush() {
+        if (emergency_ || file_ < 0) {
+            return;
+        }
+        emergency_ = true;
+        buffer* current = current_.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < options_.buffers; ++i) {
+            const buffer& b = buffers_[i];
+            if (b.sealed.load(std::memory_order_acquire) && &b != current) {
+                pwrite_all(b.data, b.size, b.offset);
+            }
+        }
+        emergency_offset_ = next_offset_;
+        if (current) {
+            const std::uint64_t committed = current->committed.load(std::memory_order_acquire);
+            const std::size_t n = committed < options_.buffer_bytes ? committed : options_.buffer_bytes;
+            pwrite_all(current->data, n, emergency_offset_);
+            emergency_offset_ += n;
+        }
+    }
+
+    bool emergency_write(const char* data, std::size_t n) {
+        if (file_ < 0) {
+            return false;
+        }
+        emergency_flush();
+        const bool ok = pwrite_all(data, n, emergency_offset_);
+        emergency_offset_ += n;
+        return ok;
+    }
+
+    // 写出剩余内容并等全部完成后关闭
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_) {
+                return;
+            }
+            stop_ = true; // 此后不再换上新的当前缓冲区
+        }
+        free_cv_.notify_all();
+        if (buffer* b = current_.exchange(nullptr, std::memory_order_acq_rel)) {
+            const std::uint64_t offset = b->reserved.fetch_add(options_.buffer_bytes + 1, std::memory_order_relaxed);
+            if (offset <= options_.buffer_bytes) {
+                rotate(b, offset);
+            } else {
+                // 另一个线程正在封口它：等它把缓冲区交出去，后台线程退出前才看得到
+                for (;;) {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        if (b->sealed.load(std::memory_order_relaxed) ||
+                            std::find(free_.begin(), free_.end(), b) != free_.end()) {
+                            break;
+                        }
+                    }
+                    std::this_thread::yield();
+                }
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            handed_over_ = true; // 最后一个缓冲区已经交给后台线程，它可以在写完后退出
+        }
+        wake_.notify_all();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+        ::close(file_);
+        file_ = -1;
+    }
+
+private:
+    struct buffer {
+        char* data = nullptr;
+        std::size_t size = 0;        // 封口时的长度
+        std::uint64_t offset = 0;
+        std::size_t written = 0;     // 短写时已完成的部分
+        int index = 0;
+        std::atomic<bool> sealed{false}; // 已封口、还没回到池里
+        std::chrono::steady_clock::time_point opened;
+        // 作为当前缓冲区时写入线程用 reserved 占位、写完后累加 committed；
+        // 封口者把 reserved 推过容量，之后迟到的占位都会落空重试。不在用时 reserved 保持越界
+        std::atomic<std::uint64_t> reserved{0};
+        std::atomic<std::uint64_t> committed{0};
+    };
+
+    explicit uring_file(const uring_file_options& options) : options_(options) {
+        if (options_.buffers == 0 || options_.buffer_bytes == 0) {
+            throw std::invalid_argument("uring_file needs at least one non-empty buffer");
+        }
+        file_ = ::open(options_.path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+        if (file_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + options_.path);
+        }
+        struct stat st {};
+        if (::fstat(file_, &st) == 0) {
+            next_offset_ = static_cast<std::uint64_t>(st.st_size); // 接着已有内容续写
+        }
+        storage_.reset(new char[options_.buffers * options_.buffer_bytes]);
+        buffers_.reset(new buffer[options_.buffers]);
+        for (std::size_t i = 0; i < options_.buffers; ++i) {
+            buffers_[i].data = storage_.get() + i * options_.buffer_bytes;
+            buffers_[i].index = static_cast<int>(i);
+            buffers_[i].reserved.store(options_.buffer_bytes + 1, std::memory_order_relaxed);
+            free_.push_back(&buffers_[i]);
+        }
+        install_locked();
+#if LOGGING_HAS_IO_URING
+        if (options_.use_io_uring && ring_.open(static_cast<unsigned>(options_.buffers))) {
+            backend_.store(uring_backend::io_uring, std::memory_order_relaxed);
+            std::vector<iovec> iov(options_.buffers);
+            for (std::size_t i = 0; i < options_.buffers; ++i) {
+                iov[i] = iovec{buffers_[i].data, options_.buffer_bytes};
+            }
+            fixed_ = ring_.register_buffers(iov.data(), static_cast<unsigned>(iov.size()));
+        }
+#endif
+        worker_ = std::thread([this] { worker_loop(); });
+    }
+
+    // 与 mapped_file 相同：一次原子加法占位再 memcpy，只有封口、换缓冲区时才加锁
+    void write_chunk(const char* data, std::size_t n) {
+        for (;;) {
+            buffer* b = current_.load(std::memory_order_acquire);
+            if (!b) {
+                // 缓冲池全部在途：等后台线程回收（背压），关闭后直接返回
+                std::unique_lock<std::mutex> lock(mutex_);
+                free_cv_.wait(lock, [&] { return stop_ || current_.load(std::memory_order_relaxed); });
+                if (stop_) {
+                    return;
+                }
+                continue;
+            }
+            const std::uint64_t offset = b->reserved.fetch_add(n, std::memory_order_relaxed);
+            if (offset + n <= options_.buffer_bytes) {
+                std::memcpy(b->data + offset, data, n);
+                b->committed.fetch_add(n, std::memory_order_release);
+                return;
+            }
+            if (offset <= options_.buffer_bytes) {
+                rotate(b, offset); // 第一个越界的写入者负责封口
+            } else {
+                std::this_thread::yield(); // 别人正在封口，或拿到的是已经换下的缓冲区
+            }
+        }
+    }
+
+    // 封口者：等先占位的写入者写完，按顺序分配文件偏移交给后台线程，再换上一个空闲缓冲区
+    void rotate(buffer* b, std::uint64_t end) {
+        while (b->committed.load(std::memory_order_acquire) < end) {
+            std::this_thread::yield();
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        const bool current = current_.load(std::memory_order_relaxed) == b;
+        if (end == 0) {
+            // 没有内容（占位与换下之间被重新启用过）：仍是当前缓冲区就原样继续用
+            if (current) {
+                b->reserved.store(0, std::memory_order_release);
+                return;
+            }
+            free_.push_back(b);
+        } else {
+            b->size = static_cast<std::size_t>(end);
+            b->offset = next_offset_;
+            b->written = 0;
+            b->sealed.store(true, std::memory_order_release);
+            next_offset_ += end;
+            sealed_.push_back(b);
+            wake_.notify_one();
+        }
+        if (current) {
+            current_.store(nullptr, std::memory_order_release);
+        }
+        install_locked();
+    }
+
+    // 调用方持有 mutex_：没有当前缓冲区时从池里取一个；先清零再发布，迟到的写入者看到的要么越界、要么是新的开始
+    void install_locked() {
+        if (stop_ || current_.load(std::memory_order_relaxed) || free_.empty()) {
+            return;
+        }
+        buffer* b = free_.back();
+        free_.pop_back();
+        b->opened = std::chrono::steady_clock::now();
+        b->committed.store(0, std::memory_order_relaxed);
+        b->reserved.store(0, std::memory_order_release);
+        current_.store(b, std::memory_order_release);
+        free_cv_.notify_all();
+    }
+
+    // 安静下来的日志也要按时写出：像一次超大的写入那样占满剩余空间，由封口者的同一条路径完成
+    void seal_if_stale() {
+        buffer* b = current_.load(std::memory_order_acquire);
+        if (!b || b->reserved.load(std::memory_order_relaxed) == 0 ||
+            std::chrono::steady_clock::now() - b->opened < options_.flush_interval) {
+            return;
+        }
+        const std::uint64_t offset = b->reserved.fetch_add(options_.buffer_bytes + 1, std::memory_order_relaxed);
+        if (offset <= options_.buffer_bytes) {
+            rotate(b, offset);
+        }
+    }
+
+    void worker_loop() {
+        std::vector<buffer*> batch;
+        std::vector<buffer*> done;
+        std::vector<buffer*> pending; // 已提交给 io_uring、还没完成
+        for (;;) {
+            seal_if_stale();
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                batch.assign(sealed_.begin(), sealed_.end());
+                sealed_.clear();
+                if (batch.empty() && pending.empty()) {
+                    if (handed_over_) {
+                        return;
+                    }
+                    wake_.wait_for(lock, options_.flush_interval,
+                                   [&] { return handed_over_ || !sealed_.empty(); });
+                    continue;
+                }
+            }
+
+            done.clear();
+#if LOGGING_HAS_IO_URING
+            if (backend() == uring_backend::io_uring) {
+                write_ring(batch, pending, done);
+            } else
+#endif
+            {
+                for (buffer* b : batch) {
+                    write_direct(b);
+                    done.push_back(b);
+                }
+            }
+
+            if (!done.empty()) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (buffer* b : done) {
+                    b->sealed.store(false, std::memory_order_relaxed);
+                }
+                free_.insert(free_.end(), done.begin(), done.end());
+                install_locked();
+                free_cv_.notify_all();
+            }
+        }
+    }
+
+#if LOGGING_HAS_IO_URING
+    // 提交这一批，有在途写入时提交和等待合并成一次系统调用，再收割完成
+    void write_ring(const std::vector<buffer*>& batch, std::vector<buffer*>& pending, std::vector<buffer*>& done) {
+        for (buffer* b : batch) {
+            submit(b);
+            pending.push_back(b);
+        }
+        for (;;) {
+            const int err = ring_.enter(!pending.empty());
+            if (err == 0) {
+                break;
+            }
+            if (err != EAGAIN && err != EBUSY) {
+                // ring 不能用了：提交出去的请求不会再有完成，改由 pwrite 写出它们，之后一直用 pwrite
+                std::fprintf(stderr, "[logger] io_uring_enter failed (%s), falling back to pwrite\n",
+                             std::strerror(err));
+                backend_.store(uring_backend::threads, std::memory_order_relaxed);
+                for (buffer* b : pending) {
+                    write_direct(b);
+                    done.push_back(b);
+                }
+                pending.clear();
+                return;
+            }
+            // 完成队列满或内核暂时缺资源：先收割已有的完成腾出位置再重试
+            if (reap(pending, done) == 0) {
+                std::this_thread::yield();
+            }
+        }
+        reap(pending, done);
+    }
+
+    unsigned reap(std::vector<buffer*>& pending, std::vector<buffer*>& done) {
+        return ring_.reap([&](std::uint64_t user_data, int res) {
+            buffer* b = &buffers_[user_data];
+            if (res > 0 && b->written + static_cast<std::size_t>(res) < b->size) {
+                b->written += static_cast<std::size_t>(res); // 短写：提交剩余部分
+                submit(b);
+                return;
+            }
+            if (res <= 0) {
+                // 出错，或一个字节也没写进去（再提交也不会有进展）
+                lost_.fetch_add(b->size - b->written, std::memory_order_relaxed);
+            }
+            pending.erase(std::find(pending.begin(), pending.end(), b));
+            done.push_back(b);
+        });
+    }
+
+    void submit(buffer* b) {
+        ring_.push_write(file_, b->data + b->written, b->size - b->written, b->offset + b->written,
+                         fixed_ ? b->index : -1, static_cast<std::uint64_t>(b->index));
+    }
+#endif
+
+    // pwrite 写出缓冲区还没写完的部分
+    void write_direct(buffer* b) {
+        if (!pwrite_all(b->data + b->written, b->size - b->written, b->offset + b->written)) {
+            lost_.fetch_add(b->size - b->written, std::memory_order_relaxed);
+        }
+    }
+
+    bool pwrite_all(const char* data, std::size_t n, std::uint64_t offset) {
+        while (n > 0) {
+            const ssize_t k = ::pwrite(file_, data, n, static_cast<off_t>(offset));
+            if (k < 0 && errno == EINTR) {
+                continue;
+            }
+            if (k <= 0) {
+                return false;
+            }
+            data += k;
+            n -= static_cast<std::size_t>(k);
+            offset += static_cast<std::uint64_t>(k);
+        }
+        return true;
+    }
+
+    uring_file_options options_;
+    std::atomic<uring_backend> backend_{uring_backend::threads};
+    int file_ = -1;
+    std::unique_ptr<char[]> storage_;
+    std::unique_ptr<buffer[]> buffers_;
+#if LOGGING_HAS_IO_URING
+    detail::io_ring ring_;
+    bool fixed_ = false;
+#endif
+    std::atomic<std::uint64_t> lost_{0};
+    std::atomic<buffer*> current_{nullptr};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;    // 有缓冲区封口
+    std::condition_variable free_cv_; // 换上了新的当前缓冲区
+    std::vector<buffer*> free_;
+    std::deque<buffer*> sealed_;
+    std::uint64_t next_offset_ = 0;
+    bool stop_ = false;
+    bool handed_over_ = false;
+    std::thread worker_;
+
+    bool emergency_ = false;
+    std::uint64_t emergency_offset_ = 0;
+};
+
+#else
+
+// 没有 POSIX 文件接口的平台上不可用
+class uring_file {
+public:
+    static std::shared_ptr<uring_file> open(const uring_file_options&) {
+        throw std::runtime_error("uring_file requires POSIX pwrite");
+    }
+
+    uring_backend backend() const { return uring_backend::threads; }
+    std::uint64_t lost_bytes() const { return 0; }
+    void write(const char*, std::size_t) {}
+    void flush() {}
+    void emergency_flush() {}
+    bool emergency_write(const char*, std::size_t) { return false; }
+    void close() {}
+};
+
+#endif
+
+} // namespace logging
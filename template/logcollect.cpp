@@ -0,0 +1,118 @@
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "log_decode.h"
+#include "log_shm.h"
+
+// 日志收集进程：从应用写入的共享内存环里取出二进制日志流，解码成文本（或原样）写文件。
+// 格式化和磁盘 I/O 都在这个进程里完成，应用崩溃后环里剩下的记录也照常落盘。
+//
+// 用法：logcollect <共享内存名> <输出文件> [--raw] [--json] [--once]
+//   --raw  : 不解码，原样写二进制流，之后可用 logdecode 还原
+//   --json : logKV 的记录写成 JSON 行
+//   --once : 只把当前内容取完就退出（事后恢复崩溃进程留下的记录）
+// 默认一直运行到生产者退出（正常关闭或进程已不存在）且环已取空；
+// 生产者不在了就删除共享内存对象（它已被重启的生产者换掉时除外）。
+// 站点定义只在流里出现一次，一个环从头到尾应由同一个收集进程读取
+namespace {
+
+using namespace std::chrono_literals;
+
+struct collector_options {
+    std::string name;
+    std::string output;
+    bool raw = false;
+    bool json = false;
+    bool once = false;
+};
+
+int collect(const collector_options& options) {
+    std::unique_ptr<logging::shm_ring> ring = logging::shm_ring::open(options.name);
+    while (!ring) {
+        if (options.once) {
+            std::cerr << "logcollect: no shared ring named " << options.name << '\n';
+            return 1;
+        }
+        std::this_thread::sleep_for(10ms);
+        ring = logging::shm_ring::open(options.name);
+    }
+
+    std::ofstream out(options.output, std::ios::binary | std::ios::app);
+    if (!out) {
+        std::cerr << "logcollect: cannot open " << options.output << '\n';
+        return 1;
+    }
+
+    logging::stream_decoder decoder(options.json ? logging::kv_format::json : logging::kv_format::text);
+    const auto consume = [&](const unsigned char* data, std::size_t n) {
+        if (options.raw) {
+            out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(n));
+        } else {
+            decoder.feed(data, n, out);
+        }
+    };
+
+    for (;;) {
+        // 先看生产者是否还在，再取数：它退出前写入的内容一定能在这一轮取到
+        const bool alive = ring->producer_alive();
+        if (ring->drain(consume) > 0) {
+            out.flush();
+            continue;
+        }
+        if (options.once || !alive) {
+            break;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    out.flush();
+
+    if (!decoder.idle()) {
+        std::cerr << "logcollect: stream ended inside a record\n";
+    }
+    if (!ring->producer_alive() && ring->is_current(options.name)) {
+        logging::shm_ring::unlink(options.name);
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    collector_options options;
+    int positional = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--raw") == 0) {
+            options.raw = true;
+        } else if (std::strcmp(argv[i], "--json") == 0) {
+            options.json = true;
+        } else if (std::strcmp(argv[i], "--once") == 0) {
+            options.once = true;
+        } else if (positional == 0) {
+            options.name = argv[i];
+            ++positional;
+        } else if (positional == 1) {
+            options.output = argv[i];
+            ++positional;
+        } else {
+            positional = -1;
+            break;
+        }
+    }
+    if (positional != 2) {
+        std::cerr << "usage: logcollect <shm-name> <output> [--raw] [--json] [--once]\n";
+        return 2;
+    }
+
+    try {
+        return collect(options);
+    } catch (const std::exception& e) {
+        std::cerr << "logcollect: " << e.what() << '\n';
+        return 1;
+    }
+}
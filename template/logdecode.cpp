@@ -0,0 +1,51 @@
+#include <fstream>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "log_decode.h"
+
+// 把 binlog / 二进制模式的异步日志还原成文本，输出与文本模式逐行一致
+// 用法：logdecode [--json] [文件]，省略文件时读标准输入；--json 把 logKV 的记录渲染成 JSON 行
+int main(int argc, char* argv[]) {
+    std::ios::sync_with_stdio(false);
+    logging::kv_format fields = logging::kv_format::text;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            fields = logging::kv_format::json;
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            std::cerr << "usage: logdecode [--json] [file]\n";
+            return 2;
+        }
+    }
+
+    std::vector<unsigned char> data;
+    if (path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "logdecode: cannot open " << path << '\n';
+            return 1;
+        }
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    } else {
+        data.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+    }
+
+    logging::stream_decoder decoder(fields);
+    try {
+        decoder.feed(data.data(), data.size(), std::cout);
+        if (!decoder.idle()) {
+            throw logging::truncated_stream();
+        }
+    } catch (const std::exception& e) {
+        std::cout.flush();
+        std::cerr << "logdecode: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
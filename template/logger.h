@@ -0,0 +1,371 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "log_async.h"
+#include "log_binary.h"
+#include "log_codec.h"
+#include "log_gather.h"
+#include "log_level.h"
+#include "log_sink.h"
+#include "log_throttle.h"
+#include "num_format.h"
+
+namespace logging::detail {
+
+// 启动了异步后端时把参数编码进当前线程的环形缓冲区，返回 false 表示应同步输出
+template <typename... Args>
+bool capture(const Args&... args);
+
+// 记录进入异步缓冲区之后：fatal 级别要等它真正写出再返回
+template <severity S>
+void committed() {
+    if constexpr (S >= severity::fatal) {
+        flush();
+    }
+}
+
+// 字符数组的内容长度：字面量的 '\0' 就在末尾，查找范围以 N 为界，不会像 strlen 那样越界
+template <std::size_t N>
+constexpr std::size_t literal_length(const char (&text)[N]) {
+    const char* end = std::char_traits<char>::find(text, N, '\0');
+    return end ? static_cast<std::size_t>(end - text) : N;
+}
+
+// 字符数组（字面量）的输出格式，与原来按 const T& 输出时一致
+inline void format_literal(std::ostream& os, std::string_view text) {
+    os << "Log: ";
+    os.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+} // namespace logging::detail
+
+// 每个特化提供 format（只负责把一条消息写进流，不换行）和 log。
+// 数值和指针由 numfmt 直接写进栈上的缓冲区，其余类型仍用 operator<<。
+// log 在异步模式下只拷贝参数，格式化由后台线程调用 format 完成；
+// 同步模式下写进输出端的缓冲区，何时写出由 flush_policy 决定。
+// log<S> 的级别低于编译期下限时函数体为空，默认级别为 info
+template <typename T, typename U = void>
+class Logger {
+public:
+    static void format(std::ostream& os, const T& message) {
+        numfmt::put(os << "Log: ", message);
+    }
+
+    template <logging::severity S = logging::severity::info>
+    static void log(const T& message) {
+        if constexpr (logging::compiled_in<S>) {
+            if (!logging::enabled<S>()) {
+                return;
+            }
+            if (logging::detail::capture(message)) {
+                logging::detail::committed<S>();
+            } else {
+                logging::detail::write_line<S>([&](std::ostream& os) { format(os, message); });
+            }
+        }
+    }
+};
+
+template <typename T>
+class Logger<T, std::enable_if_t<std::is_pointer_v<T>>> {
+public:
+    static void format(std::ostream& os, const T& message) {
+        if (message) {
+            numfmt::put(os << "Log*: ", message);
+        } else {
+            os << "Log: nullptr";
+        }
+    }
+
+    template <logging::severity S = logging::severity::info>
+    static void log(const T& message) {
+        if constexpr (logging::compiled_in<S>) {
+            if (!logging::enabled<S>()) {
+                return;
+            }
+            if (logging::detail::capture(message)) {
+                logging::detail::committed<S>();
+            } else {
+                logging::detail::write_line<S>([&](std::ostream& os) { format(os, message); });
+            }
+        }
+    }
+};
+
+// 字符串视图：按值传递两个字，不拷贝内容也不扫描 '\0'；异步模式下只把内容拷进环形缓冲区
+template <>
+class Logger<std::string_view> {
+public:
+    static void format(std::ostream& os, std::string_view message) {
+        os << "StringLog: ";
+        os.write(message.data(), static_cast<std::streamsize>(message.size()));
+    }
+
+    template <logging::severity S = logging::severity::info>
+    static void log(std::string_view message) {
+        if constexpr (logging::compiled_in<S>) {
+            if (!logging::enabled<S>()) {
+                return;
+            }
+            if (logging::detail::capture(message)) {
+                logging::detail::committed<S>();
+            } else {
+                logging::detail::write_line<S>([&](std::ostream& os) { format(os, message); });
+            }
+        }
+    }
+};
+
+template <>
+class Logger<std::string> {
+public:
+    static void format(std::ostream& os, std::string_view message) {
+        Logger<std::string_view>::format(os, message);
+    }
+
+    template <logging::severity S = logging::severity::info>
+    static void log(const std::string& message) {
+        if constexpr (logging::compiled_in<S>) {
+            if (!logging::enabled<S>()) {
+                return;
+            }
+            if (logging::detail::capture(message)) {
+                logging::detail::committed<S>();
+            } else {
+                logging::detail::write_line<S>([&](std::ostream& os) { format(os, message); });
+            }
+        }
+    }
+};
+
+// 字符数组（字符串字面量）：长度来自类型，异步模式下整块拷贝 N 个字节，调用线程不做 strlen
+template <std::size_t N>
+class Logger<char[N]> {
+public:
+    static void format(std::ostream& os, const char (&message)[N]) {
+        logging::detail::format_literal(os, std::string_view(message, logging::detail::literal_length(message)));
+    }
+
+    template <logging::severity S = logging::severity::info>
+    static void log(const char (&message)[N]) {
+        if constexpr (logging::compiled_in<S>) {
+            if (!logging::enabled<S>()) {
+                return;
+            }
+            if (logging::detail::capture(message)) {
+                logging::detail::committed<S>();
+            } else {
+                logging::detail::write_line<S>([&](std::ostream& os) { format(os, message); });
+            }
+        }
+    }
+};
+
+template <typename T>
+class LogOne {
+public:
+    template <logging::severity S = logging::severity::info>
+    static void logOne(const T& message) {
+        Logger<T>::template log<S>(message);
+    }
+};
+
+// 异步模式下整组参数作为一条记录进入缓冲区，输出时每个参数仍各占一行。
+// 参数按转发引用接收，按去掉引用和 cv 之后的类型选特化：字面量落到 Logger<char[N]>，
+// std::string / std::string_view 都只传引用，不会在调用线程拷贝。
+// 同步模式下参数都是字符串、数值或指针时整条记录用一次 writev 写出（见 log_gather.h）
+template <logging::severity S = logging::severity::info, typename... Args>
+void logAll(Args&&... args) {
+    if constexpr (logging::compiled_in<S>) {
+        if (!logging::enabled<S>()) {
+            return;
+        }
+        if (logging::detail::capture(args...)) {
+            logging::detail::committed<S>();
+        } else if (!logging::detail::gather(args...)) {
+            (LogOne<std::remove_cvref_t<Args>>::template logOne<S>(args), ...);
+        }
+    }
+}
+
+namespace logging::detail {
+
+// 有 codec 的类型只拷贝原始字节；其余类型在调用线程先格式化成文本
+template <typename T>
+std::size_t arg_size(const T& value, std::string& text) {
+    if constexpr (has_codec_v<T>) {
+        (void)text;
+        return codec<T>::size(value);
+    } else {
+        std::ostringstream os;
+        Logger<T>::format(os, value);
+        text = os.str();
+        return codec<std::string>::size(text);
+    }
+}
+
+template <typename T>
+void arg_encode(byte_writer& w, const T& value, const std::string& text) {
+    if constexpr (has_codec_v<T>) {
+        codec<T>::encode(w, value);
+    } else {
+        codec<std::string>::encode(w, text);
+    }
+}
+
+template <typename T>
+void render_arg(byte_reader& r, std::ostream& os) {
+    if constexpr (has_codec_v<T>) {
+        codec<T>::visit(r, [&](const auto& value) { Logger<T>::format(os, value); });
+    } else {
+        codec<std::string>::visit(r, [&](std::string_view text) { os << text; });
+    }
+    os << '\n';
+}
+
+template <typename... Args>
+void render_record(byte_reader& r, std::ostream& os) {
+    (render_arg<Args>(r, os), ...);
+}
+
+// 崩溃处理里的渲染：bool、字符、数值、指针和字符串按 Logger<T>::format 的格式用 numfmt / memcpy 写出，
+// 调用线程已格式化好的文本原样拷贝；其余有 codec 的类型（枚举、宽字符）的 format 可能用到 operator<<，
+// 只写占位文本
+template <typename V>
+void emergency_value(emergency_writer& out, const V& value) {
+    if constexpr (std::is_same_v<V, bool>) {
+        out.write(value ? "Log: 1" : "Log: 0", 6);
+    } else if constexpr (numfmt::is_narrow_character_v<V>) {
+        out.write("Log: ", 5).put(static_cast<char>(value));
+    } else if constexpr (numfmt::is_number_v<V> && !numfmt::is_character_v<V>) {
+        char number[numfmt::max_chars<V>];
+        out.write("Log: ", 5).write(number, numfmt::write(number, value) - number);
+    } else if constexpr (std::is_pointer_v<V>) {
+        if (!value) {
+            out.write("Log: nullptr", 12);
+        } else if constexpr (is_c_string_v<V>) {
+            out.write("Log*: ", 6).write(reinterpret_cast<const char*>(value));
+        } else {
+            char pointer[numfmt::max_pointer_chars];
+            out.write("Log*: ", 6).write(pointer, numfmt::write_pointer(pointer, value) - pointer);
+        }
+    } else if constexpr (std::is_array_v<V>) {
+        out.write("Log: ", 5).write(value, static_cast<std::streamsize>(literal_length(value)));
+    } else if constexpr (std::is_same_v<V, std::string_view>) {
+        out.write("StringLog: ", 11).write(value);
+    } else {
+        out.write("Log: <not formatted in crash handler>", 37);
+    }
+}
+
+template <typename T>
+void emergency_arg(byte_reader& r, emergency_writer& out) {
+    if constexpr (has_codec_v<T>) {
+        codec<T>::visit(r, [&](const auto& value) { emergency_value(out, value); });
+    } else {
+        codec<std::string>::visit(r, [&](std::string_view text) { out.write(text); });
+    }
+    out.put('\n');
+}
+
+template <typename... Args>
+void emergency_record(byte_reader& r, emergency_writer& out) {
+    (emergency_arg<Args>(r, out), ...);
+}
+
+template <typename... Args>
+inline constexpr record_format text_record{&render_record<Args...>, &emergency_record<Args...>};
+
+// 紧凑编码只是字节运算，两种输出共用同一个模板
+template <typename Site, typename... Args>
+inline constexpr record_format binary_record{&write_binary<Site, std::ostream, Args...>,
+                                             &write_binary<Site, emergency_writer, Args...>};
+
+// 把参数编码进环形缓冲区，由 format 在后台线程还原
+template <typename... Args, std::size_t... I>
+bool capture_encoded(const record_format* format, std::index_sequence<I...>, const Args&... args) {
+    std::string texts[sizeof...(Args)];
+    const std::size_t n = (arg_size(args, texts[I]) + ...);
+    return submit(format, n, [&](byte_writer& w) { (arg_encode(w, args, texts[I]), ...); });
+}
+
+// 调用线程的编码与模式无关，二进制模式只是换成按站点转写紧凑编码的渲染函数
+template <fixed_string Text, typename... Args, std::size_t... I>
+bool capture_impl(std::index_sequence<I...> seq, const Args&... args) {
+    const record_format* format = async_backend::instance().binary() ? &binary_record<site<Text, Args...>, Args...>
+                                                                     : &text_record<Args...>;
+    return capture_encoded(format, seq, args...);
+}
+
+template <typename... Args>
+bool capture(const Args&... args) {
+    if constexpr (sizeof...(Args) == 0) {
+        return true;
+    } else {
+        if (!async_enabled()) {
+            return false;
+        }
+        return capture_impl<"">(std::index_sequence_for<Args...>{}, args...);
+    }
+}
+
+// 带常量文本的调用点：二进制模式下文本只随站点定义写一次，文本模式下等同于把它作为第一个参数
+template <fixed_string Text, typename... Args>
+bool capture_site(const Args&... args) {
+    if (!async_enabled()) {
+        return false;
+    }
+    if (!async_backend::instance().binary()) {
+        return capture(Text.value, args...);
+    }
+    if constexpr (sizeof...(Args) == 0) {
+        return submit(&binary_record<site<Text>>, 0, [](byte_writer&) {});
+    } else {
+        return capture_impl<Text>(std::index_sequence_for<Args...>{}, args...);
+    }
+}
+
+} // namespace logging::detail
+
+namespace logging {
+
+// binlog<"连接断开">(fd, reason)：输出与 logAll("连接断开", fd, reason) 相同，
+// 二进制模式下每次只记录站点编号和参数
+template <fixed_string Text, severity S = severity::info, typename... Args>
+void binlog(const Args&... args) {
+    if constexpr (compiled_in<S>) {
+        if (!enabled<S>()) {
+            return;
+        }
+        if (detail::capture_site<Text>(args...)) {
+            detail::committed<S>();
+        } else {
+            logAll<S>(Text.value, args...);
+        }
+    }
+}
+
+// throttled<"重试", sample<100>>(args...) / throttled<"重试", rate<10, 5>>(args...)：
+// 按站点名限流的 logAll。被级别过滤掉的调用不计入限流
+template <fixed_string Site, typename Policy, severity S = severity::info, typename... Args>
+void throttled(const Args&... args) {
+    if constexpr (compiled_in<S>) {
+        if (!enabled<S>()) {
+            return;
+        }
+        using site = detail::throttle_site<Site, Policy>;
+        (void)&site::registered;
+        if (Policy::admit(site::state, site::local)) {
+            logAll<S>(args...);
+        }
+    }
+}
+
+} // namespace logging
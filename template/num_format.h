@@ -0,0 +1,182 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+// 数值格式化：写进调用方给的缓冲区，不经过 locale 和 ostream 的虚函数。
+//   整数   : 先算位数，再从低位往高位每次查表写两位
+//   浮点数 : 能精确还原的最短表示（std::to_chars，libstdc++ 与 MSVC 的实现就是 Ryu），
+//            与 ostream 默认的 6 位有效数字不同，不受 precision 影响
+//   指针   : "0x" 加小写十六进制、不补前导零，与 ostream 输出 void* 一致，每个半字节无分支地换成字符
+// 只依赖 C++17，Specialization / SFINAE 下的示例也直接包含它
+namespace numfmt {
+
+template <typename T>
+inline constexpr bool is_character_v =
+    std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char> ||
+    std::is_same_v<T, wchar_t> || std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t>
+#ifdef __cpp_char8_t
+    || std::is_same_v<T, char8_t>
+#endif
+    ;
+
+// operator<< 把指向它们的指针当作 C 字符串输出
+template <typename T>
+inline constexpr bool is_narrow_character_v =
+    std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>;
+
+// 按数值格式化的类型：除 bool 外的算术类型（字符类型在这里也按整数写）
+template <typename T>
+inline constexpr bool is_number_v = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+// 写下 T 的任意值最多需要的字节数
+template <typename T>
+inline constexpr std::size_t max_chars =
+    std::is_floating_point_v<T> ? 32 : static_cast<std::size_t>(std::numeric_limits<T>::digits10) + 2;
+
+inline constexpr std::size_t max_pointer_chars = 2 + sizeof(std::uintptr_t) * 2;
+
+namespace detail {
+
+inline constexpr char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+inline int decimal_digits(std::uint64_t value) {
+    int n = 1;
+    for (;;) {
+        if (value < 10) return n;
+        if (value < 100) return n + 1;
+        if (value < 1000) return n + 2;
+        if (value < 10000) return n + 3;
+        value /= 10000;
+        n += 4;
+    }
+}
+
+inline int leading_zeros(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return value ? __builtin_clzll(value) : 64;
+#else
+    int n = 0;
+    for (std::uint64_t bit = std::uint64_t(1) << 63; bit && !(value & bit); bit >>= 1) {
+        ++n;
+    }
+    return n;
+#endif
+}
+
+} // namespace detail
+
+inline char* write_decimal(char* out, std::uint64_t value) {
+    const int n = detail::decimal_digits(value);
+    char* p = out + n;
+    while (value >= 100) {
+        p -= 2;
+        std::memcpy(p, detail::digit_pairs + (value % 100) * 2, 2);
+        value /= 100;
+    }
+    if (value >= 10) {
+        p -= 2;
+        std::memcpy(p, detail::digit_pairs + value * 2, 2);
+    } else {
+        *--p = static_cast<char>('0' + value);
+    }
+    return out + n;
+}
+
+// 小写十六进制，不补前导零；0 写成 "0"
+inline char* write_hex(char* out, std::uint64_t value) {
+    const int n = (64 - detail::leading_zeros(value | 1) + 3) / 4;
+    for (int i = n; i-- > 0; value >>= 4) {
+        const unsigned d = static_cast<unsigned>(value & 0xF);
+        // d > 9 时 9 - d 回绕成很大的数，右移后非零，加上 'a' - '0' - 10
+        out[i] = static_cast<char>('0' + d + (((9u - d) >> 4) & ('a' - '0' - 10)));
+    }
+    return out + n;
+}
+
+inline char* write_pointer(char* out, const volatile void* pointer) {
+    out[0] = '0';
+    out[1] = 'x';
+    return write_hex(out + 2, reinterpret_cast<std::uintptr_t>(pointer));
+}
+
+#ifdef __SIZEOF_INT128__
+// 128 位整数（gnu++ 模式下 is_arithmetic 为真）：每次切下低 19 位补零写出，高位递归。
+// __extension__ 让 -Wpedantic 下不报这个 GNU 扩展
+__extension__ typedef unsigned __int128 uint128_t;
+
+inline char* write_decimal128(char* out, uint128_t value) {
+    if (value <= std::numeric_limits<std::uint64_t>::max()) {
+        return write_decimal(out, static_cast<std::uint64_t>(value));
+    }
+    constexpr std::uint64_t chunk = 10000000000000000000ull; // 10^19
+    out = write_decimal128(out, value / chunk);
+    std::uint64_t low = static_cast<std::uint64_t>(value % chunk);
+    char* end = out + 19;
+    for (char* p = end; p != out; low /= 10) {
+        *--p = static_cast<char>('0' + low % 10);
+    }
+    return end;
+}
+#endif
+
+// 把 value 写到 out 开始的至少 max_chars<T> 字节里，返回写完的位置
+template <typename T, std::enable_if_t<is_number_v<T>, int> = 0>
+char* write(char* out, T value) {
+    if constexpr (std::is_floating_point_v<T>) {
+#ifdef __cpp_lib_to_chars
+        return std::to_chars(out, out + max_chars<T>, value).ptr;
+#else
+        // 没有浮点 to_chars 时退回到能往返但不一定最短的 %.*g
+        const int n = std::snprintf(out, max_chars<T>, "%.*Lg", std::numeric_limits<T>::max_digits10,
+                                    static_cast<long double>(value));
+        // 被截断时 n 是完整长度，实际只写了 max_chars<T> - 1 个字符
+        if (n <= 0) {
+            return out;
+        }
+        return out + (static_cast<std::size_t>(n) < max_chars<T> ? static_cast<std::size_t>(n) : max_chars<T> - 1);
+#endif
+    } else if constexpr (std::is_signed_v<T>) {
+        using U = std::make_unsigned_t<T>;
+        const U magnitude = static_cast<U>(value);
+        if (value < 0) {
+            *out++ = '-';
+            return write<U>(out, static_cast<U>(U(0) - magnitude));
+        }
+        return write<U>(out, magnitude);
+#ifdef __SIZEOF_INT128__
+    } else if constexpr (sizeof(T) > sizeof(std::uint64_t)) {
+        return write_decimal128(out, value);
+#endif
+    } else {
+        return write_decimal(out, value);
+    }
+}
+
+// 写进 ostream：数值和非字符指针走上面的快速路径，bool、字符、C 字符串和其余类型仍交给 operator<<
+template <typename T>
+std::ostream& put(std::ostream& os, const T& value) {
+    if constexpr (is_number_v<T> && !is_character_v<T>) {
+        char buffer[max_chars<T>];
+        return os.write(buffer, write(buffer, value) - buffer);
+    } else if constexpr (std::is_pointer_v<T> && !is_narrow_character_v<std::remove_cv_t<std::remove_pointer_t<T>>>) {
+        if (!value) {
+            return os.put('0'); // 与 libstdc++ 输出空 void* 一致
+        }
+        char buffer[max_pointer_chars];
+        return os.write(buffer, write_pointer(buffer, reinterpret_cast<const volatile void*>(value)) - buffer);
+    } else {
+        return os << value;
+    }
+}
+
+} // namespace numfmt
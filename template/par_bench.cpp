@@ -0,0 +1,79 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "add_sub.h"
+
+// parallel_add_fold 的扩展性测试：线程数从 1 增加到 N（默认全部逻辑核，可由第一个参数指定），
+// 数据远大于末级缓存，加速比不再随线程数增长的位置就是内存带宽的上限
+
+template <typename F>
+double best_seconds(F&& f, int repeat) {
+    double best = 1e30;
+    for (int r = 0; r < repeat; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+// 防止结果被优化掉
+template <typename T>
+void keep(T value) {
+    static volatile T sink;
+    sink = value;
+    (void)sink;
+}
+
+template <typename T>
+void bench_scaling(const char* name, std::size_t n, std::size_t max_threads, sum_mode mode, const char* mode_name) {
+    std::vector<T> data(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        data[i] = static_cast<T>(i % 1000);
+    }
+    const double bytes = static_cast<double>(n * sizeof(T));
+
+    double single = 0;
+    double previous = 0;
+    T reference{};
+    bool same = true;
+    for (std::size_t threads = 1; threads <= max_threads; ++threads) {
+        par::thread_pool pool(threads, true);
+        parallel_policy policy;
+        policy.pool = &pool;
+        policy.mode = mode;
+        T result{};
+        double t = best_seconds([&] { result = parallel_add_fold(data, policy); }, 5);
+        keep(result);
+        if (threads == 1) {
+            single = t;
+            previous = t;
+            reference = result;
+        }
+        same = same && result == reference;
+        // 新增一个线程带来的吞吐增量低于 5% 时视为已到带宽上限
+        const bool saturated = threads > 1 && previous / t < 1.05;
+        std::printf("%-7s %-6s threads=%-3zu %8.2f GB/s  x%.2f%s\n", name, mode_name, threads, bytes / t / 1e9,
+                    single / t, saturated ? "  (bandwidth bound)" : "");
+        previous = t;
+    }
+    std::printf("%-7s %-6s same result for every thread count: %s\n", name, mode_name, same ? "yes" : "NO");
+}
+
+int main(int argc, char** argv) {
+    const std::size_t max_threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : par::hardware_threads();
+    const std::size_t n = std::size_t(1) << 25;
+    std::printf("runtime level: %s, logical cores: %zu\n", simd::level_name(simd::runtime_level()),
+                par::hardware_threads());
+    bench_scaling<double>("double", n, max_threads, sum_mode::naive, "naive");
+    bench_scaling<double>("double", n, max_threads, sum_mode::reproducible, "repro");
+    bench_scaling<float>("float", n, max_threads, sum_mode::naive, "naive");
+    bench_scaling<std::int32_t>("int32", n, max_threads, sum_mode::naive, "naive");
+    return 0;
+}
@@ -0,0 +1,157 @@
+// 与指令集无关的归约内核。
+// 本文件没有任何 #include，由 simd_reduce.h 在每个指令集的 target 区域内各包含一次，
+// 这样同一份模板代码会以 SSE2 / AVX2 / AVX-512 分别编译，V 是该区域内定义的向量特性类。
+
+// 多累加器向量求和：K 个互不依赖的寄存器轮流累加，借助 index_sequence 在编译期展开，
+// 浮点加法的延迟被 K 条依赖链摊薄，受限于吞吐而不是延迟。
+// 不足 K 个寄存器的尾部进第 0 个累加器，K 个累加器两两合并，剩余元素用标量收尾
+template <typename V, std::size_t K, std::size_t... I>
+typename V::value_type sum_kernel_impl(const typename V::value_type* p, std::size_t n, std::index_sequence<I...>) {
+    using T = typename V::value_type;
+    typename V::reg acc[K];
+    ((acc[I] = V::zero()), ...);
+    constexpr std::size_t stride = K * V::lanes;
+    std::size_t i = 0;
+    for (; i + stride <= n; i += stride) {
+        ((acc[I] = V::add(acc[I], V::load(p + i + I * V::lanes))), ...);
+    }
+    for (; i + V::lanes <= n; i += V::lanes) {
+        acc[0] = V::add(acc[0], V::load(p + i));
+    }
+    for (std::size_t step = 1; step < K; step *= 2) {
+        for (std::size_t k = 0; k + step < K; k += 2 * step) {
+            acc[k] = V::add(acc[k], acc[k + step]);
+        }
+    }
+    T total = V::reduce(acc[0]);
+    for (; i < n; ++i) {
+        total = lane_add(total, p[i]);
+    }
+    return total;
+}
+
+template <typename V, std::size_t K = default_accumulators>
+typename V::value_type sum_kernel(const typename V::value_type* p, std::size_t n) {
+    static_assert(K >= 1 && K <= max_accumulators, "Accumulator count must be in [1, 16]");
+    return sum_kernel_impl<V, K>(p, n, std::make_index_sequence<K>{});
+}
+
+// 向量版 TwoSum：与 two_sum_add 逐 lane 完全相同的运算
+template <typename V>
+void two_sum(typename V::reg& s, typename V::reg& c, typename V::reg x) {
+    typename V::reg t = V::add(s, x);
+    typename V::reg z = V::sub(t, s);
+    c = V::add(c, V::add(V::sub(s, V::sub(t, z)), V::sub(x, z)));
+    s = t;
+}
+
+// 预取 compensated_prefetch_bytes 之后的 count 个元素所在的缓存行；越过数组末尾的预取不会出错
+template <typename T>
+void prefetch_ahead(const T* p, std::size_t count) {
+    constexpr std::size_t line = 64 / sizeof(T);
+    for (std::size_t k = 0; k < count; k += line) {
+        __builtin_prefetch(p + k + compensated_prefetch_bytes / sizeof(T));
+    }
+}
+
+// Neumaier 补偿求和：K 对互不依赖的 (s, c) 寄存器轮流累加（借助 index_sequence 在编译期展开），
+// 每条 TwoSum 依赖链只承担 1/K 的元素；最后把 K * lanes 个部分和按固定顺序两两合并
+template <typename V, std::size_t K, std::size_t... I>
+typename V::value_type neumaier_kernel_impl(const typename V::value_type* p, std::size_t n,
+                                            std::index_sequence<I...>) {
+    using T = typename V::value_type;
+    typename V::reg s[K];
+    typename V::reg c[K];
+    ((s[I] = V::zero(), c[I] = V::zero()), ...);
+    constexpr std::size_t stride = K * V::lanes;
+    std::size_t i = 0;
+    for (; i + stride <= n; i += stride) {
+        prefetch_ahead<T>(p + i, stride);
+        (two_sum<V>(s[I], c[I], V::load(p + i + I * V::lanes)), ...);
+    }
+    for (; i + V::lanes <= n; i += V::lanes) {
+        two_sum<V>(s[0], c[0], V::load(p + i));
+    }
+    alignas(64) T sl[K * V::lanes];
+    alignas(64) T cl[K * V::lanes];
+    ((V::store(sl + I * V::lanes, s[I]), V::store(cl + I * V::lanes, c[I])), ...);
+    compensated<T> total = fold_lanes(sl, cl, K * V::lanes);
+    for (; i < n; ++i) {
+        two_sum_add(total.s, total.c, p[i]);
+    }
+    return total.s + total.c;
+}
+
+template <typename V, std::size_t K = compensated_accumulators>
+typename V::value_type neumaier_kernel(const typename V::value_type* p, std::size_t n) {
+    return neumaier_kernel_impl<V, K>(p, n, std::make_index_sequence<K>{});
+}
+
+// 可复现模式的一个块：repro_lanes<T> 个虚拟 lane 由 R = W / V::lanes 个寄存器承载，
+// 这 R 条依赖链互不相关，寄存器越窄链越多；块尾不足一整行的元素按同样的 lane 编号标量补齐，
+// 最后按 lane 编号的固定顺序合并，与标量版逐位相同
+template <typename V, std::size_t... I>
+compensated<typename V::value_type> repro_leaf_kernel_impl(const typename V::value_type* p, std::size_t n,
+                                                           std::index_sequence<I...>) {
+    using T = typename V::value_type;
+    constexpr std::size_t W = repro_lanes<T>;
+    typename V::reg s[sizeof...(I)];
+    typename V::reg c[sizeof...(I)];
+    ((s[I] = V::zero(), c[I] = V::zero()), ...);
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        prefetch_ahead<T>(p + i, W);
+        (two_sum<V>(s[I], c[I], V::load(p + i + I * V::lanes)), ...);
+    }
+    alignas(64) T sl[W];
+    alignas(64) T cl[W];
+    ((V::store(sl + I * V::lanes, s[I]), V::store(cl + I * V::lanes, c[I])), ...);
+    for (; i < n; ++i) {
+        two_sum_add(sl[i % W], cl[i % W], p[i]);
+    }
+    return fold_lanes(sl, cl, W);
+}
+
+template <typename V>
+compensated<typename V::value_type> repro_leaf_kernel(const typename V::value_type* p, std::size_t n) {
+    return repro_leaf_kernel_impl<V>(p, n, std::make_index_sequence<repro_lanes<typename V::value_type> / V::lanes>{});
+}
+
+// 整数精确求和：每个 lane 照常回绕相加，同时用无分支的位运算统计该 lane 回绕了几次
+// （有符号：两个同号数相加得到异号结果；无符号：最高位产生进位），
+// 每 exact_flush_rows<T> 行才把 lane 值与回绕次数标量合并进 wide_sum 一次
+template <typename V>
+wide_sum exact_sum_kernel(const typename V::value_type* p, std::size_t n) {
+    using T = typename V::value_type;
+    using reg = typename V::reg;
+    wide_sum acc;
+    std::size_t i = 0;
+    while (i + V::lanes <= n) {
+        reg s = V::zero();
+        reg k = V::zero();
+        for (std::size_t r = 0; r < exact_flush_rows<T> && i + V::lanes <= n; ++r, i += V::lanes) {
+            const reg x = V::load(p + i);
+            const reg t = V::add(s, x);
+            if constexpr (std::is_signed_v<T>) {
+                const reg overflow = V::sign_mask(V::bit_and(V::bit_xor(s, t), V::bit_xor(x, t)));
+                // 正溢出计 +1，负溢出计 -1：sign_mask(x) | 1 恰好是 +1 / -1
+                k = V::add(k, V::bit_and(overflow, V::bit_or(V::sign_mask(x), V::set1(T(1)))));
+            } else {
+                const reg carry = V::sign_mask(V::bit_or(V::bit_and(s, x), V::bit_andnot(t, V::bit_or(s, x))));
+                k = V::sub(k, carry);
+            }
+            s = t;
+        }
+        alignas(64) T sl[V::lanes];
+        alignas(64) T kl[V::lanes];
+        V::store(sl, s);
+        V::store(kl, k);
+        for (std::size_t j = 0; j < V::lanes; ++j) {
+            add_lane(acc, sl[j], kl[j]);
+        }
+    }
+    for (; i < n; ++i) {
+        acc.add(p[i]);
+    }
+    return acc;
+}
@@ -0,0 +1,809 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_REDUCE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// 连续内存上的向量化归约内核，运行时根据 CPUID 选择 SSE2 / AVX2 / AVX-512，
+// 不支持的平台或类型退回标量循环。
+namespace simd {
+
+enum class level { scalar, sse2, avx2, avx512 };
+
+inline const char* level_name(level l) {
+    switch (l) {
+    case level::sse2: return "sse2";
+    case level::avx2: return "avx2";
+    case level::avx512: return "avx512";
+    default: return "scalar";
+    }
+}
+
+// 查询 CPU 与操作系统实际支持的最高指令集（AVX 需要 OS 保存 YMM/ZMM 状态）
+inline level detect_level() {
+#if defined(SIMD_REDUCE_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+    __cpuid(info, 1);
+    const bool has_sse2 = (info[3] & (1 << 26)) != 0;
+    const bool has_osxsave = (info[2] & (1 << 27)) != 0;
+    const unsigned long long xcr0 = has_osxsave ? _xgetbv(0) : 0;
+    bool has_avx2 = false, has_avx512 = false;
+    if (max_leaf >= 7) {
+        __cpuidex(info, 7, 0);
+        has_avx2 = (info[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+        has_avx512 = (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0 && (xcr0 & 0xE6) == 0xE6;
+    }
+#else
+    __builtin_cpu_init();
+    const bool has_sse2 = __builtin_cpu_supports("sse2");
+    const bool has_avx2 = __builtin_cpu_supports("avx2");
+    const bool has_avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+    if (has_avx512) return level::avx512;
+    if (has_avx2) return level::avx2;
+    if (has_sse2) return level::sse2;
+#endif
+    return level::scalar;
+}
+
+// 只检测一次
+inline level runtime_level() {
+    static const level cached = detect_level();
+    return cached;
+}
+
+// 有向量内核的元素类型：float / double 以及除 bool 外的整数
+template <typename T>
+inline constexpr bool has_kernel_v =
+    std::is_same_v<T, float> || std::is_same_v<T, double> ||
+    (std::is_integral_v<T> && !std::is_same_v<T, bool>);
+
+// 多累加器求和的累加器个数上限；add_fold<unroll<K>>(range) 用 K 指定个数
+inline constexpr std::size_t max_accumulators = 16;
+
+template <std::size_t K>
+struct unroll {
+    static_assert(K >= 1 && K <= max_accumulators, "Accumulator count must be in [1, 16]");
+    static constexpr std::size_t accumulators = K;
+};
+
+template <typename U>
+struct is_unroll : std::false_type {};
+
+template <std::size_t K>
+struct is_unroll<unroll<K>> : std::true_type {};
+
+// 整数按无符号回绕，避免有符号溢出的未定义行为；与 SIMD 的回绕加法结果一致
+template <typename T>
+constexpr T lane_add(T a, T b) {
+    if constexpr (std::is_integral_v<T>) {
+        using U = std::make_unsigned_t<T>;
+        return static_cast<T>(static_cast<U>(a) + static_cast<U>(b));
+    } else {
+        return a + b;
+    }
+}
+
+template <typename T>
+constexpr T lane_sub(T a, T b) {
+    if constexpr (std::is_integral_v<T>) {
+        using U = std::make_unsigned_t<T>;
+        return static_cast<T>(static_cast<U>(a) - static_cast<U>(b));
+    } else {
+        return a - b;
+    }
+}
+
+// 浮点求和策略
+//   naive        : 直接累加（区间上按指令集宽度分 lane，结果随指令集变化）
+//   pairwise     : 两两分治，误差随 log(n) 增长
+//   neumaier     : Kahan–Babuška / Neumaier 补偿求和，误差与 n 基本无关
+//   reproducible : 固定分块、固定 lane 数、固定合并树，结果逐位可复现，
+//                  与指令集以及并行时的线程数都无关
+enum class sum_mode { naive, pairwise, neumaier, reproducible };
+
+// 带补偿项的部分和：真实值约为 s + c
+template <typename T>
+struct compensated {
+    T s{};
+    T c{};
+};
+
+// TwoSum：把 x 加到 s 上，并把这一步的舍入误差精确地累加到 c 中（无分支，可逐 lane 向量化）
+template <typename T>
+constexpr void two_sum_add(T& s, T& c, T x) {
+    T t = s + x;
+    T z = t - s;
+    c += (s - (t - z)) + (x - z);
+    s = t;
+}
+
+template <typename T>
+constexpr compensated<T> combine(compensated<T> a, compensated<T> b) {
+    two_sum_add(a.s, a.c, b.s);
+    a.c += b.c;
+    return a;
+}
+
+// 按固定的两两分治顺序原地合并各 lane 的部分和，依赖链只有 log2(lanes) 层。
+// 写成循环而不是递归，便于内联进各指令集的内核（避免从 AVX 代码调用非 VEX 的标量函数）
+template <typename T>
+constexpr compensated<T> fold_lanes(T* s, T* c, std::size_t lanes) {
+    for (std::size_t step = 1; step < lanes; step *= 2) {
+        for (std::size_t k = 0; k + step < lanes; k += 2 * step) {
+            two_sum_add(s[k], c[k], s[k + step]);
+            c[k] += c[k + step];
+        }
+    }
+    return compensated<T>{s[0], c[0]};
+}
+
+// 可复现模式的固定参数：每块 4096 个元素，每块内按 256 字节宽的"虚拟 lane"交错累加。
+// 任何指令集都按同样的 lane 划分运算，所以结果逐位一致；
+// 256 字节让 AVX-512 也有 4 条互不依赖的 TwoSum 链，补偿求和受吞吐而不是加法延迟限制
+inline constexpr std::size_t repro_block = 4096;
+inline constexpr std::size_t repro_bytes = 256;
+
+template <typename T>
+inline constexpr std::size_t repro_lanes = sizeof(T) < repro_bytes ? repro_bytes / sizeof(T) : 1;
+
+// 补偿求和每个元素要做 6 次加减，同样的带宽下发出的加载比朴素求和稀疏，硬件预取跟不上；
+// 向量内核在主循环里提前这么多字节逐缓存行软件预取
+inline constexpr std::size_t compensated_prefetch_bytes = 4096;
+
+// 补偿求和向量内核的独立累加器个数：TwoSum 链的加法延迟约 4 个周期，
+// 4 条链足以让内核受加法吞吐而不是延迟限制，SSE2 下 8 个寄存器也不会溢出
+inline constexpr std::size_t compensated_accumulators = 4;
+
+// 固定形状的分块合并树：只取决于块数，不取决于谁算了哪一块
+template <typename T, typename Leaf>
+constexpr compensated<T> repro_tree(const T* p, std::size_t n, std::size_t first_block, std::size_t blocks, Leaf&& leaf) {
+    if (blocks == 1) {
+        const std::size_t begin = first_block * repro_block;
+        const std::size_t len = n - begin < repro_block ? n - begin : repro_block;
+        return leaf(p + begin, len);
+    }
+    const std::size_t half = blocks / 2;
+    return combine(repro_tree(p, n, first_block, half, leaf),
+                   repro_tree(p, n, first_block + half, blocks - half, leaf));
+}
+
+template <typename T, typename Leaf>
+constexpr T repro_sum(const T* p, std::size_t n, Leaf&& leaf) {
+    if (n == 0) {
+        return T{};
+    }
+    const compensated<T> total = repro_tree(p, n, 0, (n + repro_block - 1) / repro_block, leaf);
+    return total.s + total.c;
+}
+
+// 整数溢出策略
+//   wrap       : 按补码回绕（模 2^w），与区间求和的默认行为相同
+//   checked    : 给出回绕后的值，并报告精确结果是否超出 T 的范围
+//   saturating : 精确结果截断到 T 的取值范围
+// 判断依据是数学上的精确和，与运算顺序无关，所以可以分 lane 累加、最后只检查一次
+enum class overflow_mode { wrap, checked, saturating };
+
+// 整数精确和的 128 位累加器：真实值为 hi * 2^64 + lo（lo 按无符号解释）
+struct wide_sum {
+    std::uint64_t lo = 0;
+    std::int64_t hi = 0;
+
+    // 有符号数先符号扩展到 64 位再相加，进位与借位并入 hi
+    template <typename T>
+    constexpr void add(T v) {
+        const std::uint64_t u = static_cast<std::uint64_t>(v);
+        lo += u;
+        hi += lo < u ? 1 : 0;
+        if constexpr (std::is_signed_v<T>) {
+            hi -= v < 0 ? 1 : 0;
+        }
+    }
+
+    constexpr void sub(const wide_sum& other) {
+        hi -= other.hi + (lo < other.lo ? 1 : 0);
+        lo -= other.lo;
+    }
+
+    template <typename T>
+    constexpr bool fits() const {
+        constexpr std::uint64_t max = static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+        if constexpr (std::is_signed_v<T>) {
+            constexpr std::uint64_t min = static_cast<std::uint64_t>(std::numeric_limits<T>::min());
+            return (hi == 0 && lo <= max) || (hi == -1 && lo >= min);
+        } else {
+            return hi == 0 && lo <= max;
+        }
+    }
+
+    template <typename T>
+    constexpr T wrapped() const {
+        return static_cast<T>(lo);
+    }
+
+    template <typename T>
+    constexpr T saturated() const {
+        if (fits<T>()) {
+            return wrapped<T>();
+        }
+        return hi < 0 ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+    }
+};
+
+// 一个 lane 的回绕和 v 加上回绕次数 k，真实值为 v + k * 2^w
+template <typename T>
+constexpr void add_lane(wide_sum& acc, T v, T k) {
+    if constexpr (sizeof(T) == 8) {
+        acc.add(v);
+        acc.hi += static_cast<std::int64_t>(k);
+    } else {
+        acc.add(static_cast<std::int64_t>(v) + static_cast<std::int64_t>(k) * (std::int64_t(1) << (8 * sizeof(T))));
+    }
+}
+
+// 向量内核每累加这么多行就把 lane 并入 wide_sum 一次，保证同宽度的回绕计数自身不会溢出
+template <typename T>
+inline constexpr std::size_t exact_flush_rows = sizeof(T) == 1 ? 127 : sizeof(T) == 2 ? 32767 : 65536;
+
+namespace scalar {
+
+// 标量同样用 K 个累加器打断依赖链，默认 4 个
+template <typename T, std::size_t K = 4>
+T sum_kernel(const T* p, std::size_t n) {
+    T acc[K]{};
+    std::size_t i = 0;
+    for (; i + K <= n; i += K) {
+        for (std::size_t k = 0; k < K; ++k) {
+            acc[k] = lane_add(acc[k], p[i + k]);
+        }
+    }
+    for (std::size_t step = 1; step < K; step *= 2) {
+        for (std::size_t k = 0; k + step < K; k += 2 * step) {
+            acc[k] = lane_add(acc[k], acc[k + step]);
+        }
+    }
+    T total = acc[0];
+    for (; i < n; ++i) {
+        total = lane_add(total, p[i]);
+    }
+    return total;
+}
+
+template <typename T>
+constexpr T pairwise(const T* p, std::size_t n) {
+    if (n == 0) {
+        return T{};
+    }
+    if (n == 1) {
+        return p[0];
+    }
+    const std::size_t half = n / 2;
+    return pairwise(p, half) + pairwise(p + half, n - half);
+}
+
+template <typename T>
+constexpr T neumaier(const T* p, std::size_t n) {
+    compensated<T> acc{};
+    for (std::size_t i = 0; i < n; ++i) {
+        two_sum_add(acc.s, acc.c, p[i]);
+    }
+    return acc.s + acc.c;
+}
+
+// 与向量内核逐 lane 相同的运算顺序：第 i 个元素进入第 i % W 个 lane
+template <typename T>
+constexpr compensated<T> repro_leaf(const T* p, std::size_t n) {
+    constexpr std::size_t W = repro_lanes<T>;
+    T s[W]{};
+    T c[W]{};
+    for (std::size_t i = 0; i < n; ++i) {
+        two_sum_add(s[i % W], c[i % W], p[i]);
+    }
+    return fold_lanes(s, c, W);
+}
+
+template <typename T>
+constexpr wide_sum exact_sum(const T* p, std::size_t n) {
+    wide_sum acc;
+    for (std::size_t i = 0; i < n; ++i) {
+        acc.add(p[i]);
+    }
+    return acc;
+}
+
+// 常量求值与无向量内核的浮点类型（如 long double）都走这里
+template <sum_mode M, typename T>
+constexpr T sum(const T* p, std::size_t n) {
+    if constexpr (M == sum_mode::pairwise) {
+        return pairwise(p, n);
+    } else if constexpr (M == sum_mode::neumaier) {
+        return neumaier(p, n);
+    } else if constexpr (M == sum_mode::reproducible) {
+        return repro_sum(p, n, [](const T* q, std::size_t len) { return repro_leaf(q, len); });
+    } else {
+        T total{};
+        for (std::size_t i = 0; i < n; ++i) {
+            total = total + p[i];
+        }
+        return total;
+    }
+}
+
+} // namespace scalar
+
+#if defined(SIMD_REDUCE_X86)
+
+// ---------------------------------------------------------------- SSE2
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+namespace sse2 {
+
+// 只有 SSE2 的老核心加法延迟约 3 拍、每拍一条，4 个累加器即可填满流水线
+inline constexpr std::size_t default_accumulators = 4;
+
+template <typename T, typename = void>
+struct vec;
+
+template <>
+struct vec<float> {
+    using value_type = float;
+    using reg = __m128;
+    static constexpr std::size_t lanes = 4;
+    static reg zero() { return _mm_setzero_ps(); }
+    static reg load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, reg r) { _mm_storeu_ps(p, r); }
+    static reg add(reg a, reg b) { return _mm_add_ps(a, b); }
+    static reg sub(reg a, reg b) { return _mm_sub_ps(a, b); }
+    static float reduce(reg r) {
+        reg s = _mm_add_ps(r, _mm_movehl_ps(r, r));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 0x55));
+        return _mm_cvtss_f32(s);
+    }
+};
+
+template <>
+struct vec<double> {
+    using value_type = double;
+    using reg = __m128d;
+    static constexpr std::size_t lanes = 2;
+    static reg zero() { return _mm_setzero_pd(); }
+    static reg load(const double* p) { return _mm_loadu_pd(p); }
+    static void store(double* p, reg r) { _mm_storeu_pd(p, r); }
+    static reg add(reg a, reg b) { return _mm_add_pd(a, b); }
+    static reg sub(reg a, reg b) { return _mm_sub_pd(a, b); }
+    static double reduce(reg r) { return _mm_cvtsd_f64(_mm_add_sd(r, _mm_unpackhi_pd(r, r))); }
+};
+
+template <typename T>
+struct vec<T, std::enable_if_t<std::is_integral_v<T>>> {
+    using value_type = T;
+    using reg = __m128i;
+    static constexpr std::size_t lanes = 16 / sizeof(T);
+    static reg zero() { return _mm_setzero_si128(); }
+    static reg load(const T* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(T* p, reg r) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), r); }
+    static reg add(reg a, reg b) {
+        if constexpr (sizeof(T) == 1) return _mm_add_epi8(a, b);
+        else if constexpr (sizeof(T) == 2) return _mm_add_epi16(a, b);
+        else if constexpr (sizeof(T) == 4) return _mm_add_epi32(a, b);
+        else return _mm_add_epi64(a, b);
+    }
+    static reg sub(reg a, reg b) {
+        if constexpr (sizeof(T) == 1) return _mm_sub_epi8(a, b);
+        else if constexpr (sizeof(T) == 2) return _mm_sub_epi16(a, b);
+        else if constexpr (sizeof(T) == 4) return _mm_sub_epi32(a, b);
+        else return _mm_sub_epi64(a, b);
+    }
+    static reg set1(T x) {
+        if constexpr (sizeof(T) == 1) return _mm_set1_epi8(static_cast<char>(x));
+        else if constexpr (sizeof(T) == 2) return _mm_set1_epi16(static_cast<short>(x));
+        else if constexpr (sizeof(T) == 4) return _mm_set1_epi32(static_cast<int>(x));
+        else return _mm_set1_epi64x(static_cast<long long>(x));
+    }
+    static reg bit_and(reg a, reg b) { return _mm_and_si128(a, b); }
+    static reg bit_or(reg a, reg b) { return _mm_or_si128(a, b); }
+    static reg bit_xor(reg a, reg b) { return _mm_xor_si128(a, b); }
+    static reg bit_andnot(reg a, reg b) { return _mm_andnot_si128(a, b); }
+    // 把每个 lane 的最高位广播到整个 lane；SSE2 没有 64 位算术右移，取高 32 位的结果复制
+    static reg sign_mask(reg r) {
+        if constexpr (sizeof(T) == 1) return _mm_cmpgt_epi8(_mm_setzero_si128(), r);
+        else if constexpr (sizeof(T) == 2) return _mm_srai_epi16(r, 15);
+        else if constexpr (sizeof(T) == 4) return _mm_srai_epi32(r, 31);
+        else return _mm_shuffle_epi32(_mm_srai_epi32(r, 31), _MM_SHUFFLE(3, 3, 1, 1));
+    }
+    // 8 位用 SAD、16 位用 madd 先扩宽再归约，回绕结果与逐个相加一致
+    static T reduce(reg r) {
+        if constexpr (sizeof(T) == 1) {
+            reg s = _mm_sad_epu8(r, _mm_setzero_si128());
+            return static_cast<T>(_mm_cvtsi128_si32(_mm_add_epi64(s, _mm_unpackhi_epi64(s, s))));
+        } else if constexpr (sizeof(T) == 2) {
+            return static_cast<T>(reduce32(_mm_madd_epi16(r, _mm_set1_epi16(1))));
+        } else if constexpr (sizeof(T) == 4) {
+            return static_cast<T>(reduce32(r));
+        } else {
+            reg s = _mm_add_epi64(r, _mm_unpackhi_epi64(r, r));
+            long long low;
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(&low), s);
+            return static_cast<T>(low);
+        }
+    }
+    static int reduce32(reg r) {
+        reg s = _mm_add_epi32(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(1, 0, 3, 2)));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(s);
+    }
+};
+
+#include "simd_kernels.inl"
+
+} // namespace sse2
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+// ---------------------------------------------------------------- AVX2
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace avx2 {
+
+// Haswell 之后加法延迟 4 拍、每拍两条，需要 8 条独立的依赖链
+inline constexpr std::size_t default_accumulators = 8;
+
+template <typename T, typename = void>
+struct vec;
+
+template <>
+struct vec<float> {
+    using value_type = float;
+    using reg = __m256;
+    static constexpr std::size_t lanes = 8;
+    static reg zero() { return _mm256_setzero_ps(); }
+    static reg load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, reg r) { _mm256_storeu_ps(p, r); }
+    static reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+    static reg sub(reg a, reg b) { return _mm256_sub_ps(a, b); }
+    static float reduce(reg r) {
+        return sse2::vec<float>::reduce(_mm_add_ps(_mm256_castps256_ps128(r), _mm256_extractf128_ps(r, 1)));
+    }
+};
+
+template <>
+struct vec<double> {
+    using value_type = double;
+    using reg = __m256d;
+    static constexpr std::size_t lanes = 4;
+    static reg zero() { return _mm256_setzero_pd(); }
+    static reg load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, reg r) { _mm256_storeu_pd(p, r); }
+    static reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+    static reg sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+    static double reduce(reg r) {
+        return sse2::vec<double>::reduce(_mm_add_pd(_mm256_castpd256_pd128(r), _mm256_extractf128_pd(r, 1)));
+    }
+};
+
+template <typename T>
+struct vec<T, std::enable_if_t<std::is_integral_v<T>>> {
+    using value_type = T;
+    using reg = __m256i;
+    static constexpr std::size_t lanes = 32 / sizeof(T);
+    static reg zero() { return _mm256_setzero_si256(); }
+    static reg load(const T* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(T* p, reg r) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), r); }
+    static reg add(reg a, reg b) {
+        if constexpr (sizeof(T) == 1) return _mm256_add_epi8(a, b);
+        else if constexpr (sizeof(T) == 2) return _mm256_add_epi16(a, b);
+        else if constexpr (sizeof(T) == 4) return _mm256_add_epi32(a, b);
+        else return _mm256_add_epi64(a, b);
+    }
+    static reg sub(reg a, reg b) {
+        if constexpr (sizeof(T) == 1) return _mm256_sub_epi8(a, b);
+        else if constexpr (sizeof(T) == 2) return _mm256_sub_epi16(a, b);
+        else if constexpr (sizeof(T) == 4) return _mm256_sub_epi32(a, b);
+        else return _mm256_sub_epi64(a, b);
+    }
+    static reg set1(T x) {
+        if constexpr (sizeof(T) == 1) return _mm256_set1_epi8(static_cast<char>(x));
+        else if constexpr (sizeof(T) == 2) return _mm256_set1_epi16(static_cast<short>(x));
+        else if constexpr (sizeof(T) == 4) return _mm256_set1_epi32(static_cast<int>(x));
+        else return _mm256_set1_epi64x(static_cast<long long>(x));
+    }
+    static reg bit_and(reg a, reg b) { return _mm256_and_si256(a, b); }
+    static reg bit_or(reg a, reg b) { return _mm256_or_si256(a, b); }
+    static reg bit_xor(reg a, reg b) { return _mm256_xor_si256(a, b); }
+    static reg bit_andnot(reg a, reg b) { return _mm256_andnot_si256(a, b); }
+    static reg sign_mask(reg r) {
+        if constexpr (sizeof(T) == 1) return _mm256_cmpgt_epi8(_mm256_setzero_si256(), r);
+        else if constexpr (sizeof(T) == 2) return _mm256_srai_epi16(r, 15);
+        else if constexpr (sizeof(T) == 4) return _mm256_srai_epi32(r, 31);
+        else return _mm256_shuffle_epi32(_mm256_srai_epi32(r, 31), _MM_SHUFFLE(3, 3, 1, 1));
+    }
+    static T reduce(reg r) {
+        using half = sse2::vec<T>;
+        return half::reduce(half::add(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1)));
+    }
+};
+
+#include "simd_kernels.inl"
+
+} // namespace avx2
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+// ---------------------------------------------------------------- AVX-512
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f,avx512bw"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512bw")
+#endif
+
+namespace avx512 {
+
+// 两个 512 位加法端口、延迟 4 拍；再多累加器只会拉长尾部
+inline constexpr std::size_t default_accumulators = 8;
+
+template <typename T, typename = void>
+struct vec;
+
+template <>
+struct vec<float> {
+    using value_type = float;
+    using reg = __m512;
+    static constexpr std::size_t lanes = 16;
+    static reg zero() { return _mm512_setzero_ps(); }
+    static reg load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, reg r) { _mm512_storeu_ps(p, r); }
+    static reg add(reg a, reg b) { return _mm512_add_ps(a, b); }
+    static reg sub(reg a, reg b) { return _mm512_sub_ps(a, b); }
+    // GCC 12 的非掩码 extract 内部用了未初始化寄存器，-O3 下会误报 -Wuninitialized，统一用零掩码版本取两半
+    static float reduce(reg r) {
+        __m512d d = _mm512_castps_pd(r);
+        __m256 lo = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF, d, 0));
+        __m256 hi = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF, d, 1));
+        return avx2::vec<float>::reduce(_mm256_add_ps(lo, hi));
+    }
+};
+
+template <>
+struct vec<double> {
+    using value_type = double;
+    using reg = __m512d;
+    static constexpr std::size_t lanes = 8;
+    static reg zero() { return _mm512_setzero_pd(); }
+    static reg load(const double* p) { return _mm512_loadu_pd(p); }
+    static void store(double* p, reg r) { _mm512_storeu_pd(p, r); }
+    static reg add(reg a, reg b) { return _mm512_add_pd(a, b); }
+    static reg sub(reg a, reg b) { return _mm512_sub_pd(a, b); }
+    static double reduce(reg r) {
+        __m256d lo = _mm512_maskz_extractf64x4_pd(0xF, r, 0);
+        __m256d hi = _mm512_maskz_extractf64x4_pd(0xF, r, 1);
+        return avx2::vec<double>::reduce(_mm256_add_pd(lo, hi));
+    }
+};
+
+template <typename T>
+struct vec<T, std::enable_if_t<std::is_integral_v<T>>> {
+    using value_type = T;
+    using reg = __m512i;
+    static constexpr std::size_t lanes = 64 / sizeof(T);
+    static reg zero() { return _mm512_setzero_si512(); }
+    static reg load(const T* p) { return _mm512_loadu_si512(p); }
+    static void store(T* p, reg r) { _mm512_storeu_si512(p, r); }
+    static reg add(reg a, reg b) {
+        if constexpr (sizeof(T) == 1) return _mm512_add_epi8(a, b);
+        else if constexpr (sizeof(T) == 2) return _mm512_add_epi16(a, b);
+        else if constexpr (sizeof(T) == 4) return _mm512_add_epi32(a, b);
+        else return _mm512_add_epi64(a, b);
+    }
+    static reg sub(reg a, reg b) {
+        if constexpr (sizeof(T) == 1) return _mm512_sub_epi8(a, b);
+        else if constexpr (sizeof(T) == 2) return _mm512_sub_epi16(a, b);
+        else if constexpr (sizeof(T) == 4) return _mm512_sub_epi32(a, b);
+        else return _mm512_sub_epi64(a, b);
+    }
+    static reg set1(T x) {
+        if constexpr (sizeof(T) == 1) return _mm512_set1_epi8(static_cast<char>(x));
+        else if constexpr (sizeof(T) == 2) return _mm512_set1_epi16(static_cast<short>(x));
+        else if constexpr (sizeof(T) == 4) return _mm512_set1_epi32(static_cast<int>(x));
+        else return _mm512_set1_epi64(static_cast<long long>(x));
+    }
+    static reg bit_and(reg a, reg b) { return _mm512_and_si512(a, b); }
+    static reg bit_or(reg a, reg b) { return _mm512_or_si512(a, b); }
+    static reg bit_xor(reg a, reg b) { return _mm512_xor_si512(a, b); }
+    // 与 reduce 相同，全掩码的零掩码版本避开 GCC 12 的 -Wmaybe-uninitialized 误报
+    static reg bit_andnot(reg a, reg b) { return _mm512_maskz_andnot_epi64(0xFF, a, b); }
+    static reg sign_mask(reg r) {
+        if constexpr (sizeof(T) == 1) return _mm512_movm_epi8(_mm512_movepi8_mask(r));
+        else if constexpr (sizeof(T) == 2) return _mm512_srai_epi16(r, 15);
+        else if constexpr (sizeof(T) == 4) return _mm512_maskz_srai_epi32(0xFFFF, r, 31);
+        else return _mm512_maskz_srai_epi64(0xFF, r, 63);
+    }
+    static T reduce(reg r) {
+        using half = avx2::vec<T>;
+        return half::reduce(half::add(_mm512_maskz_extracti64x4_epi64(0xF, r, 0),
+                                      _mm512_maskz_extracti64x4_epi64(0xF, r, 1)));
+    }
+};
+
+#include "simd_kernels.inl"
+
+} // namespace avx512
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // SIMD_REDUCE_X86
+
+// 按指定指令集求和，累加器个数取该指令集的默认值；调用方需保证 lvl 不高于 runtime_level()
+template <typename T>
+T sum(const T* p, std::size_t n, level lvl) {
+    static_assert(has_kernel_v<T>, "No SIMD kernel for this element type");
+#if defined(SIMD_REDUCE_X86)
+    switch (lvl) {
+    case level::avx512: return avx512::sum_kernel<avx512::vec<T>>(p, n);
+    case level::avx2: return avx2::sum_kernel<avx2::vec<T>>(p, n);
+    case level::sse2: return sse2::sum_kernel<sse2::vec<T>>(p, n);
+    default: break;
+    }
+#else
+    (void)lvl;
+#endif
+    return scalar::sum_kernel(p, n);
+}
+
+template <typename T>
+T sum(const T* p, std::size_t n) {
+    return sum(p, n, runtime_level());
+}
+
+// 指定累加器个数的版本，K 对所有指令集相同
+template <std::size_t K, typename T>
+T sum_unrolled(const T* p, std::size_t n, level lvl) {
+    static_assert(has_kernel_v<T>, "No SIMD kernel for this element type");
+#if defined(SIMD_REDUCE_X86)
+    switch (lvl) {
+    case level::avx512: return avx512::sum_kernel<avx512::vec<T>, K>(p, n);
+    case level::avx2: return avx2::sum_kernel<avx2::vec<T>, K>(p, n);
+    case level::sse2: return sse2::sum_kernel<sse2::vec<T>, K>(p, n);
+    default: break;
+    }
+#else
+    (void)lvl;
+#endif
+    return scalar::sum_kernel<T, K>(p, n);
+}
+
+template <std::size_t K, typename T>
+T sum_unrolled(const T* p, std::size_t n) {
+    return sum_unrolled<K>(p, n, runtime_level());
+}
+
+// 两两分治：叶子足够大时交给向量内核，避免递归开销
+inline constexpr std::size_t pairwise_leaf = 256;
+
+template <typename T>
+T pairwise_sum(const T* p, std::size_t n, level lvl) {
+    if (n <= pairwise_leaf) {
+        return sum(p, n, lvl);
+    }
+    const std::size_t half = n / 2;
+    return pairwise_sum(p, half, lvl) + pairwise_sum(p + half, n - half, lvl);
+}
+
+template <typename T>
+T neumaier_sum(const T* p, std::size_t n, level lvl) {
+#if defined(SIMD_REDUCE_X86)
+    switch (lvl) {
+    case level::avx512: return avx512::neumaier_kernel<avx512::vec<T>>(p, n);
+    case level::avx2: return avx2::neumaier_kernel<avx2::vec<T>>(p, n);
+    case level::sse2: return sse2::neumaier_kernel<sse2::vec<T>>(p, n);
+    default: break;
+    }
+#else
+    (void)lvl;
+#endif
+    return scalar::neumaier(p, n);
+}
+
+template <typename T>
+compensated<T> repro_leaf(const T* p, std::size_t n, level lvl) {
+#if defined(SIMD_REDUCE_X86)
+    switch (lvl) {
+    case level::avx512: return avx512::repro_leaf_kernel<avx512::vec<T>>(p, n);
+    case level::avx2: return avx2::repro_leaf_kernel<avx2::vec<T>>(p, n);
+    case level::sse2: return sse2::repro_leaf_kernel<sse2::vec<T>>(p, n);
+    default: break;
+    }
+#else
+    (void)lvl;
+#endif
+    return scalar::repro_leaf(p, n);
+}
+
+// 整数区间的精确和，供 checked / saturating 两种溢出策略使用
+template <typename T>
+wide_sum exact_sum(const T* p, std::size_t n, level lvl) {
+    static_assert(std::is_integral_v<T> && has_kernel_v<T>, "Exact sum requires an integral element type");
+#if defined(SIMD_REDUCE_X86)
+    switch (lvl) {
+    case level::avx512: return avx512::exact_sum_kernel<avx512::vec<T>>(p, n);
+    case level::avx2: return avx2::exact_sum_kernel<avx2::vec<T>>(p, n);
+    case level::sse2: return sse2::exact_sum_kernel<sse2::vec<T>>(p, n);
+    default: break;
+    }
+#else
+    (void)lvl;
+#endif
+    return scalar::exact_sum(p, n);
+}
+
+template <typename T>
+wide_sum exact_sum(const T* p, std::size_t n) {
+    return exact_sum(p, n, runtime_level());
+}
+
+// 按求和策略归约；整数求和本身是精确的（模 2^n），策略对整数不起作用
+template <typename T>
+T sum(const T* p, std::size_t n, sum_mode mode, level lvl) {
+    if constexpr (!std::is_floating_point_v<T>) {
+        (void)mode;
+        return sum(p, n, lvl);
+    } else if constexpr (!has_kernel_v<T>) {
+        (void)lvl;
+        switch (mode) {
+        case sum_mode::pairwise: return scalar::sum<sum_mode::pairwise>(p, n);
+        case sum_mode::neumaier: return scalar::sum<sum_mode::neumaier>(p, n);
+        case sum_mode::reproducible: return scalar::sum<sum_mode::reproducible>(p, n);
+        default: return scalar::sum<sum_mode::naive>(p, n);
+        }
+    } else {
+        switch (mode) {
+        case sum_mode::pairwise: return pairwise_sum(p, n, lvl);
+        case sum_mode::neumaier: return neumaier_sum(p, n, lvl);
+        case sum_mode::reproducible:
+            return repro_sum(p, n, [lvl](const T* q, std::size_t len) { return repro_leaf(q, len, lvl); });
+        default: return sum(p, n, lvl);
+        }
+    }
+}
+
+template <typename T>
+T sum(const T* p, std::size_t n, sum_mode mode) {
+    return sum(p, n, mode, runtime_level());
+}
+
+} // namespace simd
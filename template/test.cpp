@@ -1,72 +1,23 @@
+#include <cstdint>
+#include <iomanip>
 #include <iostream>
-#include <type_traits>
-
-// 1. 检测类型是否支持加法
-template <typename T, typename = void>
-struct is_addable : std::false_type {};
-
-template <typename T>
-struct is_addable<T, decltype(void(std::declval<T>() + std::declval<T>()))> : std::true_type {};
-
-// 2. 可变参数加法的实现
-template <typename T, typename... Args>
-constexpr auto add(T first, Args... args) {
-    // 确保所有类型相同且支持加法
-    static_assert(is_addable<T>::value, "Type must be addable");
-    static_assert((std::is_same_v<T, Args> && ...), "All types must be the same");
-
-    if constexpr (sizeof...(args) == 0) {
-        return first;
-    } else {
-        return first + add(args...);
-    }
-}
-
-// 折叠表达式实现（C++17）
-template <typename... Args>
-constexpr auto add_fold(Args... args) {
-    // 确保至少有一个参数且所有类型相同
-    static_assert(sizeof...(args) > 0, "At least one argument is required");
-    using CommnType = std::common_type_t<Args...>;
-
-    // 确保支持加法
-    static_assert(is_addable<CommnType>::value, "Type must be addable");
-    
-    // 使用折叠表达式进行加法
-    return (... + args); 
-}
-
-// 检测类型是否支持减法
-template <typename T, typename = void>
-struct is_subable : std::false_type {};
-
-template <typename T>
-struct is_subable<T, decltype(void(std::declval<T>() - std::declval<T>()))> : std::true_type {};
-
-// 可变参数减法的实现
-template <typename T, typename... Args>
-constexpr auto sub(T first, Args... args) {
-    static_assert(is_subable<T>::value, "Type must be subable");
-    static_assert((std::is_same_v<T, Args> && ...), "All types must be the same");
-    if constexpr (sizeof...(args) == 0) {
-        return first;
-    } else {
-        return first - sub(args...);
-    }
-}
+#include <span>
+#include <string>
+#include <vector>
 
-// 折叠表达式实现的减法
-template <typename... Args>
-constexpr auto sub_fold(Args... args) {
-    static_assert(sizeof...(args) > 0, "At least one argument is required");
-    using CommonType = std::common_type_t<Args...>;
+#include "add_sub.h"
 
-    static_assert(is_subable<CommonType>::value, "Type must be subable");
+// 接入表达式模板的自定义定长数组：继承 expr::expression 并提供 size / operator[]
+struct vec3 : expr::expression<vec3> {
+    double v[3]{};
 
-    // 左折叠表达式进行减法
-    return (... - args);
-}
+    vec3() = default;
+    vec3(double x, double y, double z) : v{x, y, z} {}
 
+    std::size_t size() const { return 3; }
+    double& operator[](std::size_t i) { return v[i]; }
+    double operator[](std::size_t i) const { return v[i]; }
+};
 
 int main() {   
     // 测试整数加法
@@ -91,6 +42,16 @@ int main() {
     std::cout << "Sum using add (string): " << str4 << std::endl;
     std::cout << "Sum using add_fold (string): " << str5 << std::endl;
 
+    // 字符串拼接可以混用 std::string_view / const char*，右值首参数的缓冲区会被复用
+    std::string_view sv("-");
+    std::string head("Hello");
+    head.reserve(64);
+    const char* head_data = head.data();
+    std::string msg = add(std::move(head), ", ", str1, sv, str2, sv, str3);
+    std::cout << "Sum using add (mixed string pieces): " << msg
+              << (msg.data() == head_data ? " (buffer reused)" : "") << std::endl;
+    std::cout << "Sum using add_fold (mixed string pieces): " << add_fold("[", str1, sv, str3, "]") << std::endl;
+
     // 测试不同类型的加法（编译时错误）
     // auto sum5 = add(1, 3.14);
     constexpr auto sum6 = add_fold(1, 3.14); 
@@ -111,5 +72,108 @@ int main() {
     // auto sub5 = sub(10, 2.0);
     auto sub6 = sub_fold(10, 2.0);
     std::cout << "Sub using sub_fold with mixed types: " << sub6 << std::endl;
+
+    // 测试平衡树版本：与递归版本的左右结合语义一致
+    std::cout << "Testing add_tree / sub_tree / sub_fold_tree:" << std::endl;
+    constexpr int tree1 = add_tree(1, 2, 3, 4, 5);
+    constexpr int tree2 = sub_tree(10, 2, 2, 7, 1);
+    constexpr int tree3 = sub_fold_tree(10, 2, 2, 7, 1);
+    static_assert(tree2 == sub(10, 2, 2, 7, 1), "sub_tree must match sub");
+    static_assert(tree3 == sub_fold(10, 2, 2, 7, 1), "sub_fold_tree must match sub_fold");
+    std::cout << "Sum using add_tree: " << tree1 << std::endl;
+    std::cout << "Sub using sub_tree: " << tree2 << std::endl;
+    std::cout << "Sub using sub_fold_tree: " << tree3 << std::endl;
+    std::cout << "Sum using add_tree (string): " << add_tree(str1, str2, str3) << std::endl;
+
+    // 测试表达式模板：数组类型的 add / sub_fold 融合成一个循环
+    std::cout << "Testing expression templates:" << std::endl;
+    expr::vector<int> va{1, 2, 3}, vb{10, 20, 30}, vc{100, 200, 300}, vd{1000, 2000, 3000};
+    expr::vector<int> vsum = add(va, vb, vc, vd);
+    expr::vector<int> vsub = sub(vd, vc, vb, va);
+    expr::vector<int> vsub_fold = sub_fold(vd, vc, vb, va);
+    expr::vector<int> vmix = va + vb - vc;
+    static_assert(is_addable<expr::vector<int>>::value && is_subable<vec3>::value, "expression types must be detected");
+    std::cout << "add (expr::vector):";
+    for (int x : vsum) std::cout << ' ' << x;
+    std::cout << "\nsub (expr::vector):";
+    for (int x : vsub) std::cout << ' ' << x;
+    std::cout << "\nsub_fold (expr::vector):";
+    for (int x : vsub_fold) std::cout << ' ' << x;
+    std::cout << "\na + b - c (expr::vector):";
+    for (int x : vmix) std::cout << ' ' << x;
+    vec3 p3 = sub_fold(vec3(10, 10, 10), vec3(1, 2, 3), vec3(0.5, 0.5, 0.5));
+    std::cout << "\nsub_fold (vec3): " << p3[0] << ' ' << p3[1] << ' ' << p3[2] << std::endl;
+
+    // 测试连续区间的向量化折叠
+    std::cout << "Testing range add_fold and sub_fold (simd: "
+              << simd::level_name(simd::runtime_level()) << "):" << std::endl;
+    std::vector<double> values(1000);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = 0.5 * static_cast<double>(i);
+    }
+    std::cout << "Sum using add_fold (vector<double>): " << add_fold(values) << std::endl;
+
+    int ints[] = {100, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    std::span<int> view(ints);
+    std::cout << "Sum using add_fold (span<int>): " << add_fold(view) << std::endl;
+    std::cout << "Sub using sub_fold (span<int>): " << sub_fold(view) << std::endl;
+
+    std::vector<std::string> words{str1, str2, str3};
+    std::cout << "Sum using add_fold (vector<string>): " << add_fold(words) << std::endl;
+
+    // 测试求和策略：1e16 + 1 + ... 朴素累加会把小量全部舍掉
+    std::cout << std::setprecision(17);
+    std::cout << "Testing summation modes:" << std::endl;
+    constexpr double naive = add<sum_mode::naive>(1e16, 1.0, 1.0, 1.0, 1.0, -1e16);
+    constexpr double pairwise = add<sum_mode::pairwise>(1e16, 1.0, 1.0, 1.0, 1.0, -1e16);
+    constexpr double neumaier = add_fold<sum_mode::neumaier>(1e16, 1.0, 1.0, 1.0, 1.0, -1e16);
+    constexpr double repro = add_fold<sum_mode::reproducible>(1e16, 1.0, 1.0, 1.0, 1.0, -1e16);
+    std::cout << "naive: " << naive << ", pairwise: " << pairwise
+              << ", neumaier: " << neumaier << ", reproducible: " << repro << std::endl;
+
+    std::vector<double> tenths(100000, 0.1);
+    std::cout << "Sum of 100000 x 0.1 (naive): " << add_fold<sum_mode::naive>(tenths) << std::endl;
+    std::cout << "Sum of 100000 x 0.1 (pairwise): " << add_fold<sum_mode::pairwise>(tenths) << std::endl;
+    std::cout << "Sum of 100000 x 0.1 (neumaier): " << add_fold<sum_mode::neumaier>(tenths) << std::endl;
+    std::cout << "Sum of 100000 x 0.1 (reproducible): " << add_fold<sum_mode::reproducible>(tenths) << std::endl;
+
+    // 测试整数溢出策略：判断的是精确结果，中间越界不算溢出
+    std::cout << "Testing overflow modes:" << std::endl;
+    constexpr auto checked1 = add_fold<overflow_mode::checked>(2147483647, 1);
+    constexpr auto checked2 = add_fold<overflow_mode::checked>(2147483647, 1, -1);
+    static_assert(checked1.overflow && !checked2.overflow && checked2.value == 2147483647, "checked add_fold");
+    static_assert(add<overflow_mode::saturating>(std::int8_t(100), std::int8_t(100)) == 127, "saturating add");
+    static_assert(sub_fold<overflow_mode::saturating>(1u, 2u, 3u) == 0u, "saturating sub_fold");
+    std::cout << "checked add_fold (INT_MAX + 1): value " << checked1.value << ", overflow " << checked1.overflow
+              << std::endl;
+    std::vector<std::int8_t> bytes(1000, 100);
+    const auto checked_bytes = add_fold<overflow_mode::checked>(bytes);
+    std::cout << "checked add_fold (1000 x int8 100): value " << int(checked_bytes.value) << ", overflow "
+              << checked_bytes.overflow << std::endl;
+    std::cout << "saturating add_fold (1000 x int8 100): " << int(add_fold<overflow_mode::saturating>(bytes))
+              << std::endl;
+    std::vector<std::int64_t> big(3, INT64_MAX);
+    big.push_back(INT64_MIN);
+    big.push_back(INT64_MIN);
+    const auto checked_big = add_fold<overflow_mode::checked>(big);
+    std::cout << "checked add_fold (3 x INT64_MAX + 2 x INT64_MIN): value " << checked_big.value << ", overflow "
+              << checked_big.overflow << std::endl;
+    std::cout << "saturating sub_fold (span<int>): " << sub_fold<overflow_mode::saturating>(view) << std::endl;
+
+    // 测试多线程归约：结果与线程数无关，可复现模式与单线程逐位相同
+    std::cout << "Testing parallel_add_fold:" << std::endl;
+    par::thread_pool pool(4);
+    parallel_policy policy;
+    policy.grain = 4096;
+    policy.pool = &pool;
+    policy.mode = sum_mode::reproducible;
+    const double par_repro = parallel_add_fold(tenths, policy);
+    std::cout << "parallel_add_fold (reproducible, 4 threads): " << par_repro
+              << (par_repro == add_fold<sum_mode::reproducible>(tenths) ? " (matches add_fold)" : " (MISMATCH)")
+              << std::endl;
+    policy.mode = sum_mode::neumaier;
+    std::cout << "parallel_add_fold (neumaier, 4 threads): " << parallel_add_fold(tenths, policy) << std::endl;
+    std::vector<int> many(1000000, 3);
+    std::cout << "parallel_add_fold (vector<int>, shared pool): " << parallel_add_fold(many) << std::endl;
     return 0;
 }
\ No newline at end of file
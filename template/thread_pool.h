@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// 固定大小的线程池，只提供一个阻塞的 parallel-for：run(tasks, fn) 让所有线程
+// （包括调用线程）按原子计数器领取任务下标 0..tasks-1，全部完成后返回。
+// 任务下标与由哪个线程执行无关，调用方据此可以得到与线程数无关的结果
+namespace par {
+
+// 把当前线程绑定到第 cpu 个逻辑核；非 Linux 平台忽略
+inline void pin_current_thread(std::size_t cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<int>(cpu % CPU_SETSIZE), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+inline std::size_t hardware_threads() {
+    const unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+class thread_pool {
+public:
+    // threads 为 0 时使用全部逻辑核，调用线程也算一个。
+    // pin 为 true 时第 i 个工作线程绑定到第 i 个逻辑核；调用线程的亲和性不做改动
+    explicit thread_pool(std::size_t threads = 0, bool pin = false)
+        : threads_(threads == 0 ? hardware_threads() : threads), pinned_(pin) {
+        for (std::size_t i = 1; i < threads_; ++i) {
+            workers_.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& t : workers_) {
+            t.join();
+        }
+    }
+
+    std::size_t size() const { return threads_; }
+    bool pinned() const { return pinned_; }
+
+    // 同一时刻只允许一个 run；任务内抛出的异常不会跨线程传播，任务应当不抛异常
+    void run(std::size_t tasks, const std::function<void(std::size_t)>& fn) {
+        if (tasks == 0) {
+            return;
+        }
+        if (workers_.empty() || tasks == 1) {
+            for (std::size_t i = 0; i < tasks; ++i) {
+                fn(i);
+            }
+            return;
+        }
+        std::lock_guard<std::mutex> run_lock(run_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &fn;
+            tasks_ = tasks;
+            next_.store(0, std::memory_order_relaxed);
+            active_ = workers_.size();
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        drain(fn, tasks);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return active_ == 0; });
+        job_ = nullptr;
+    }
+
+private:
+    void drain(const std::function<void(std::size_t)>& fn, std::size_t tasks) {
+        for (std::size_t i = next_.fetch_add(1, std::memory_order_relaxed); i < tasks;
+             i = next_.fetch_add(1, std::memory_order_relaxed)) {
+            fn(i);
+        }
+    }
+
+    void worker_loop(std::size_t index) {
+        if (pinned_) {
+            pin_current_thread(index);
+        }
+        std::size_t seen = 0;
+        for (;;) {
+            const std::function<void(std::size_t)>* fn;
+            std::size_t tasks;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+                fn = job_;
+                tasks = tasks_;
+            }
+            drain(*fn, tasks);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--active_ == 0) {
+                    done_.notify_one();
+                }
+            }
+        }
+    }
+
+    std::size_t threads_;
+    bool pinned_;
+    std::vector<std::thread> workers_;
+
+    std::mutex run_mutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(std::size_t)>* job_ = nullptr;
+    std::size_t tasks_ = 0;
+    std::atomic<std::size_t> next_{0};
+    std::size_t active_ = 0;
+    std::size_t generation_ = 0;
+    bool stop_ = false;
+};
+
+// 按 (线程数, 是否绑核) 复用的共享线程池，配置变化时换一个新的。
+// 调用方在整个归约期间持有返回的 shared_ptr：换掉的旧池等最后一个持有者用完才析构
+inline std::shared_ptr<thread_pool> shared_pool(std::size_t threads, bool pin) {
+    static std::mutex mutex;
+    static std::shared_ptr<thread_pool> pool;
+    const std::size_t want = threads == 0 ? hardware_threads() : threads;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!pool || pool->size() != want || pool->pinned() != pin) {
+        pool = std::make_shared<thread_pool>(want, pin);
+    }
+    return pool;
+}
+
+} // namespace par